@@ -10,6 +10,11 @@ plugins {
 group = "com.github.rizukirr"
 version = "1.0.0"
 
+// Optional: build the audx core (denoiser, resampler, RNNoise) from an
+// audx-realtime checkout with LTO instead of linking the prebuilt
+// libaudx_src.so, e.g. ./gradlew assembleRelease -Paudx.coreSourceDir=/path/to/audx-realtime
+val audxCoreSourceDir: String? = providers.gradleProperty("audx.coreSourceDir").orNull
+
 android {
     namespace = "com.android.audx"
     compileSdk = 36  // Fixed syntax error
@@ -31,6 +36,17 @@ android {
         ndk {
             abiFilters += listOf("arm64-v8a", "x86_64")
         }
+
+        externalNativeBuild {
+            cmake {
+                if (audxCoreSourceDir != null) {
+                    arguments += listOf(
+                        "-DAUDX_BUILD_CORE_FROM_SOURCE=ON",
+                        "-DAUDX_CORE_SOURCE_DIR=$audxCoreSourceDir"
+                    )
+                }
+            }
+        }
     }
 
     buildTypes {
@@ -61,6 +77,15 @@ android {
         }
     }
 
+    // The core is linked statically into libaudx.so when built from source
+    packaging {
+        jniLibs {
+            if (audxCoreSourceDir != null) {
+                excludes += "**/libaudx_src.so"
+            }
+        }
+    }
+
     buildFeatures {
         viewBinding = false  // Not needed for library without UI
     }
@@ -7,14 +7,18 @@ import org.junit.After
 import org.junit.Assert.assertEquals
 import org.junit.Assert.assertFalse
 import org.junit.Assert.assertNotNull
+import org.junit.Assert.assertNull
 import org.junit.Assert.assertTrue
 import org.junit.Assert.fail
 import org.junit.Before
 import org.junit.Test
 import org.junit.runner.RunWith
+import java.io.File
 import java.io.InputStream
 import java.nio.ByteBuffer
 import java.nio.ByteOrder
+import java.util.concurrent.atomic.AtomicBoolean
+import java.util.concurrent.atomic.AtomicInteger
 
 /**
  * Instrumented tests for the Denoiser library.
@@ -919,6 +923,1075 @@ class DenoiserInstrumentedTest {
         assertEquals("Session 2 should have 3 frames", 3, session2Stats?.frameProcessed)
     }
 
+    @Test
+    fun testStats_ConcurrentPolling_SnapshotsAreConsistent() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val frameSize = AudxDenoiser.FRAME_SIZE
+        val framesToProcess = 500
+
+        val denoiser = AudxDenoiser.Builder()
+            .collectStatistics(true)
+            .onProcessedAudio { _, _ -> }
+            .build()
+        audxDenoiser = denoiser
+
+        val done = AtomicBoolean(false)
+        val violations = AtomicInteger(0)
+        val polls = AtomicInteger(0)
+        val poller = Thread {
+            var lastFrames = 0
+            while (!done.get()) {
+                val stats = denoiser.getStats() ?: continue
+                polls.incrementAndGet()
+                // Every field must come from the same frame
+                val speechPercentOk = stats.speechDetectedPercent in 0.0f..100.0f
+                val vadOk = stats.frameProcessed == 0 ||
+                    (stats.vadScoreMin <= stats.vadScoreAvg + 1e-4f &&
+                        stats.vadScoreAvg <= stats.vadScoreMax + 1e-4f)
+                val monotonic = stats.frameProcessed >= lastFrames
+                if (!speechPercentOk || !vadOk || !monotonic) {
+                    violations.incrementAndGet()
+                }
+                lastFrames = stats.frameProcessed
+            }
+        }
+        poller.start()
+
+        for (i in 0 until framesToProcess) {
+            val start = i * frameSize
+            val end = start + frameSize
+            if (end > audioData.size) break
+            denoiser.processChunk(audioData.copyOfRange(start, end))
+        }
+
+        done.set(true)
+        poller.join()
+
+        assertTrue("Poller should have read snapshots", polls.get() > 0)
+        assertEquals("Snapshots should never be torn", 0, violations.get())
+        assertEquals(
+            "All frames should be counted",
+            framesToProcess,
+            denoiser.getStats()?.frameProcessed
+        )
+    }
+
+    @Test
+    fun testResetStats_VisibleImmediately() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val frameSize = AudxDenoiser.FRAME_SIZE
+
+        audxDenoiser = AudxDenoiser.Builder()
+            .collectStatistics(true)
+            .onProcessedAudio { _, _ -> }
+            .build()
+
+        for (i in 0 until 10) {
+            audxDenoiser?.processChunk(audioData.copyOfRange(i * frameSize, (i + 1) * frameSize))
+        }
+        assertEquals(10, audxDenoiser?.getStats()?.frameProcessed)
+
+        // No frame has run since the reset, but the snapshot must already reflect it
+        audxDenoiser?.resetStats()
+        val stats = audxDenoiser?.getStats()
+        assertEquals("Frames should be 0 right after reset", 0, stats?.frameProcessed)
+        assertEquals("Total time should be 0 right after reset", 0.0f, stats?.processingTimeTotal ?: -1.0f, 0.0f)
+
+        audxDenoiser?.processChunk(audioData.copyOfRange(0, frameSize))
+        assertEquals("Counting should resume after reset", 1, audxDenoiser?.getStats()?.frameProcessed)
+    }
+
+    @Test
+    fun testStats_LatencyPercentiles() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val frameSize = AudxDenoiser.FRAME_SIZE
+
+        audxDenoiser = AudxDenoiser.Builder()
+            .collectStatistics(true)
+            .onProcessedAudio { _, _ -> }
+            .build()
+
+        val empty = audxDenoiser?.getStats()
+        assertEquals("No latency before processing", 0.0f, empty?.endToEndLatency?.max ?: -1.0f, 0.0f)
+
+        for (i in 0 until 200) {
+            audxDenoiser?.processChunk(audioData.copyOfRange(i * frameSize, (i + 1) * frameSize))
+        }
+
+        val stats = audxDenoiser?.getStats()
+        assertNotNull(stats)
+        for (latency in listOf(stats!!.processingLatency, stats.endToEndLatency)) {
+            assertTrue("p50 should be > 0", latency.p50 > 0.0f)
+            assertTrue("p50 <= p95", latency.p50 <= latency.p95)
+            assertTrue("p95 <= p99", latency.p95 <= latency.p99)
+            assertTrue("p99 <= p999", latency.p99 <= latency.p999)
+            assertTrue("p999 <= max", latency.p999 <= latency.max)
+            assertTrue(
+                "Over-budget frames should not exceed frames processed",
+                latency.overBudgetFrames in 0..stats.frameProcessed
+            )
+        }
+        assertTrue(
+            "End-to-end time should include the denoiser time",
+            stats.endToEndLatency.max >= stats.processingLatency.p50
+        )
+
+        audxDenoiser?.resetStats()
+        val reset = audxDenoiser?.getStats()
+        assertEquals("Latency should reset with stats", 0.0f, reset?.processingLatency?.p50 ?: -1.0f, 0.0f)
+        assertEquals(0, reset?.endToEndLatency?.overBudgetFrames)
+    }
+
+    @Test
+    fun testStageTimings_DisabledByDefault() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val frameSize = AudxDenoiser.FRAME_SIZE
+
+        audxDenoiser = AudxDenoiser.Builder()
+            .onProcessedAudio { _, _ -> }
+            .build()
+
+        for (i in 0 until 10) {
+            audxDenoiser?.processChunk(audioData.copyOfRange(i * frameSize, (i + 1) * frameSize))
+        }
+
+        val timings = audxDenoiser?.getStageTimings()
+        assertNotNull(timings)
+        assertEquals("No stage should be timed while disabled", 0, timings!!.denoise.frames)
+        assertEquals(0, timings.arrayAccess.frames)
+    }
+
+    @Test
+    fun testStageTimings_Resampled_AllStagesRecorded() = runBlocking {
+        val inputRate = 16000
+        val frameSize = inputRate / 100  // 10ms
+        val audioData = ShortArray(frameSize * 50) { i -> ((i % 100) * 100).toShort() }
+
+        audxDenoiser = AudxDenoiser.Builder()
+            .inputSampleRate(inputRate)
+            .onProcessedAudio { _, _ -> }
+            .build()
+        audxDenoiser?.setStageTimingEnabled(true)
+
+        audxDenoiser?.processChunk(audioData)
+
+        val timings = audxDenoiser?.getStageTimings()
+        assertNotNull(timings)
+        for (stage in listOf(
+            timings!!.arrayAccess, timings.upsample, timings.denoise,
+            timings.downsample, timings.resultMarshalling
+        )) {
+            assertEquals("Every stage should run once per frame", 50, stage.frames)
+            assertTrue("Stage time should be >= 0", stage.totalMs >= 0.0f)
+            assertTrue("Max should be >= avg", stage.maxMs >= stage.avgMs)
+        }
+
+        audxDenoiser?.resetStats()
+        assertEquals("Timings should reset with stats", 0, audxDenoiser?.getStageTimings()?.denoise?.frames)
+    }
+
+    @Test
+    fun testStageTimings_FloatInput_ConversionAndAnalysisRecorded() = runBlocking {
+        val inputRate = 16000
+        val frameSize = inputRate / 100
+        val audioData = FloatArray(frameSize * 50) { i -> (i % 100) / 200.0f }
+
+        audxDenoiser = AudxDenoiser.Builder()
+            .inputSampleRate(inputRate)
+            .bandFeatures(true)
+            .onProcessedFloatAudio { _, _ -> }
+            .build()
+        audxDenoiser?.setStageTimingEnabled(true)
+
+        audxDenoiser?.processChunk(audioData)
+
+        val timings = audxDenoiser?.getStageTimings()
+        assertNotNull(timings)
+        assertEquals(50, timings!!.convert.frames)
+        assertEquals(50, timings.bandAnalysis.frames)
+        assertEquals(50, timings.denoise.frames)
+    }
+
+    // ==================== Tracing Tests ====================
+
+    @Test
+    fun testTracing_DoesNotChangeOutput() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val frameSize = AudxDenoiser.FRAME_SIZE
+        val input = audioData.copyOfRange(0, frameSize * 20)
+
+        fun denoise(): ShortArray {
+            val output = mutableListOf<Short>()
+            val denoiser = AudxDenoiser.Builder()
+                .onProcessedAudio { audio, _ -> output.addAll(audio.toList()) }
+                .build()
+            runBlocking { denoiser.processChunk(input) }
+            denoiser.destroy()
+            return output.toShortArray()
+        }
+
+        val reference = denoise()
+        try {
+            AudxDenoiser.setTracingEnabled(true)
+            val traced = denoise()
+            assertTrue("Tracing must not change the output", reference.contentEquals(traced))
+        } finally {
+            AudxDenoiser.setTracingEnabled(false)
+        }
+    }
+
+    // ==================== Denormal Tests ====================
+
+    @Test
+    fun testSilenceDecay_FrameTimeStaysFlat() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val frameSize = AudxDenoiser.FRAME_SIZE
+        val speechFrames = 500
+        val silenceFrames = 6000  // 60 s of digital silence
+        val window = 1000
+
+        audxDenoiser = AudxDenoiser.Builder()
+            .onProcessedAudio { _, _ -> }
+            .build()
+
+        suspend fun meanFrameNanos(frames: Int, frameAt: (Int) -> ShortArray): Double {
+            val start = System.nanoTime()
+            for (i in 0 until frames) {
+                audxDenoiser?.processChunk(frameAt(i))
+            }
+            return (System.nanoTime() - start).toDouble() / frames
+        }
+
+        val speechMean = meanFrameNanos(speechFrames) { i ->
+            audioData.copyOfRange(i * frameSize, (i + 1) * frameSize)
+        }
+
+        // Filter and GRU state decays through the subnormal range during
+        // silence; without flush-to-zero late windows get several times slower
+        val silence = ShortArray(frameSize)
+        var worstRatio = 0.0
+        for (w in 0 until silenceFrames / window) {
+            val mean = meanFrameNanos(window) { silence }
+            worstRatio = maxOf(worstRatio, mean / speechMean)
+        }
+
+        assertTrue(
+            "Frame time in silence should stay flat (worst window ${"%.2f".format(worstRatio)}x speech)",
+            worstRatio < 3.0
+        )
+    }
+
+    // ==================== Reset Tests ====================
+
+    @Test
+    fun testReset_OutputMatchesFreshDenoiser() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val inputRate = 16000
+        val input = audioData.copyOfRange(0, inputRate / 100 * 100)
+
+        val output = mutableListOf<Short>()
+        audxDenoiser = AudxDenoiser.Builder()
+            .inputSampleRate(inputRate)
+            .collectStatistics(true)
+            .onProcessedAudio { audio, _ -> output.addAll(audio.toList()) }
+            .build()
+
+        audxDenoiser?.processChunk(input)
+        val first = output.toShortArray()
+
+        output.clear()
+        audxDenoiser?.processChunk(ShortArray(50))  // Left buffered, then discarded
+        audxDenoiser?.reset()
+        assertEquals(0, audxDenoiser?.getStats()?.frameProcessed)
+
+        audxDenoiser?.processChunk(input)
+        assertTrue("Output after reset() should match a new denoiser",
+            first.contentEquals(output.toShortArray()))
+    }
+
+    // ==================== Rate Switching Tests ====================
+
+    @Test
+    fun testSetInputSampleRate_KeepsStateAndResizesFrames() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val frameSizes = mutableListOf<Int>()
+        audxDenoiser = AudxDenoiser.Builder()
+            .inputSampleRate(16000)
+            .collectStatistics(true)
+            .onProcessedAudio { audio, _ -> frameSizes.add(audio.size) }
+            .build()
+
+        audxDenoiser?.processChunk(audioData.copyOfRange(0, 16000))
+        audxDenoiser?.processChunk(ShortArray(50))  // Partial frame, flushed at 16 kHz
+        audxDenoiser?.setInputSampleRate(8000)
+        assertEquals(101, frameSizes.size)
+        assertEquals(50, frameSizes.last())
+
+        frameSizes.clear()
+        audxDenoiser?.processChunk(audioData.copyOfRange(0, 8000))
+        assertEquals(100, frameSizes.size)
+        assertTrue("Frames after the switch should be 10 ms at 8 kHz", frameSizes.all { it == 80 })
+
+        // Same denoiser: statistics carry on across the switch
+        assertEquals(201, audxDenoiser?.getStats()?.frameProcessed)
+    }
+
+    @Test
+    fun testSetInputSampleRate_RejectsOutOfRange() = runBlocking {
+        audxDenoiser = AudxDenoiser.Builder()
+            .inputSampleRate(16000)
+            .onProcessedAudio { _, _ -> }
+            .build()
+
+        for (rate in listOf(4000, 96000)) {
+            try {
+                audxDenoiser?.setInputSampleRate(rate)
+                fail("Rate $rate should be rejected")
+            } catch (e: IllegalArgumentException) {
+                // Expected
+            }
+        }
+        audxDenoiser?.processChunk(ShortArray(160))  // Still usable at 16 kHz
+    }
+
+    // ==================== Float Output Tests ====================
+
+    @Test
+    fun testFloatOutput_MatchesShortOutputWithinQuantization() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        for (inputRate in listOf(48000, 16000)) {
+            val input = audioData.copyOfRange(0, inputRate / 100 * 50 + 37)
+
+            val shorts = mutableListOf<Short>()
+            AudxDenoiser.Builder()
+                .inputSampleRate(inputRate)
+                .onProcessedAudio { audio, _ -> shorts.addAll(audio.toList()) }
+                .build().use {
+                    it.processChunk(input)
+                    it.flush()
+                }
+
+            val floats = mutableListOf<Float>()
+            AudxDenoiser.Builder()
+                .inputSampleRate(inputRate)
+                .onProcessedFloatAudio { audio, _ -> floats.addAll(audio.toList()) }
+                .build().use {
+                    it.processChunk(input)
+                    it.flush()
+                }
+
+            assertEquals(input.size, floats.size)
+            assertEquals(shorts.size, floats.size)
+            for (i in floats.indices) {
+                val scaled = (floats[i] * 32768.0f).coerceIn(-32768.0f, 32767.0f)
+                assertTrue("Sample $i at $inputRate Hz: ${floats[i]} vs ${shorts[i]}",
+                    Math.abs(scaled - shorts[i]) <= 1.0f)
+            }
+        }
+    }
+
+    @Test
+    fun testFloatInput_MatchesShortInput() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        for (inputRate in listOf(48000, 16000)) {
+            val input = audioData.copyOfRange(0, inputRate / 100 * 50 + 37)
+
+            suspend fun denoise(feed: suspend (AudxDenoiser) -> Unit): FloatArray {
+                val out = mutableListOf<Float>()
+                AudxDenoiser.Builder()
+                    .inputSampleRate(inputRate)
+                    .onProcessedFloatAudio { audio, _ -> out.addAll(audio.toList()) }
+                    .build().use {
+                        feed(it)
+                        it.flush()
+                    }
+                return out.toFloatArray()
+            }
+
+            val fromShorts = denoise { it.processChunk(input) }
+            val fromFloats = denoise {
+                it.processChunk(FloatArray(input.size) { i -> input[i] / 32768.0f })
+            }
+
+            assertEquals(input.size, fromFloats.size)
+            for (i in fromFloats.indices) {
+                // Bit-identical at 48kHz; the int16 upsampler output rounds at other rates
+                assertTrue("Sample $i at $inputRate Hz",
+                    Math.abs(fromFloats[i] - fromShorts[i]) * 32768.0f <= 2.0f)
+            }
+        }
+    }
+
+    @Test
+    fun testFloatPaths_MatchShortPathStatsAndVad() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val input = audioData.copyOfRange(0, AudxDenoiser.FRAME_SIZE * 100)
+
+        suspend fun run(
+            configure: AudxDenoiser.Builder.(MutableList<Float>) -> Unit,
+            feed: suspend (AudxDenoiser) -> Unit
+        ): Pair<List<Float>, DenoiserStats> {
+            val vad = mutableListOf<Float>()
+            val denoiser = AudxDenoiser.Builder().collectStatistics(true).apply { configure(vad) }.build()
+            feed(denoiser)
+            val stats = requireNotNull(denoiser.getStats())
+            denoiser.destroy()
+            return vad to stats
+        }
+
+        val (shortVad, shortStats) = run(
+            { vad -> onProcessedAudio { _, result -> vad.add(result.vadProbability) } },
+            { it.processChunk(input) }
+        )
+        val floatOutput = run(
+            { vad -> onProcessedFloatAudio { _, result -> vad.add(result.vadProbability) } },
+            { it.processChunk(input) }
+        )
+        val floatInput = run(
+            { vad -> onProcessedFloatAudio { _, result -> vad.add(result.vadProbability) } },
+            { it.processChunk(FloatArray(input.size) { i -> input[i] / 32768.0f }) }
+        )
+
+        for ((name, path) in listOf("float output" to floatOutput, "float input" to floatInput)) {
+            val (vad, stats) = path
+            assertEquals("Per-frame VAD, $name", shortVad, vad)
+            assertEquals("frameProcessed, $name", shortStats.frameProcessed, stats.frameProcessed)
+            assertEquals("speechDetectedPercent, $name",
+                shortStats.speechDetectedPercent, stats.speechDetectedPercent)
+            assertEquals("vadScoreAvg, $name", shortStats.vadScoreAvg, stats.vadScoreAvg)
+            assertEquals("vadScoreMin, $name", shortStats.vadScoreMin, stats.vadScoreMin)
+            assertEquals("vadScoreMax, $name", shortStats.vadScoreMax, stats.vadScoreMax)
+        }
+    }
+
+    @Test
+    fun testFloatBufferCallback_MatchesFloatArrayCallback() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val inputRate = 16000
+        val input = audioData.copyOfRange(0, inputRate / 100 * 20 + 37)  // Partial last frame
+
+        val expected = mutableListOf<Float>()
+        AudxDenoiser.Builder()
+            .inputSampleRate(inputRate)
+            .onProcessedFloatAudio { audio, _ -> expected.addAll(audio.toList()) }
+            .build().use {
+                it.processChunk(input)
+                it.flush()
+            }
+
+        val actual = mutableListOf<Float>()
+        AudxDenoiser.Builder()
+            .inputSampleRate(inputRate)
+            .onProcessedFloatBuffer { audio, _ ->
+                assertEquals(0, audio.position())
+                while (audio.hasRemaining()) actual.add(audio.get())
+            }
+            .build().use {
+                it.processChunk(input)
+                it.flush()
+            }
+
+        assertEquals(input.size, actual.size)
+        assertTrue(expected.toFloatArray().contentEquals(actual.toFloatArray()))
+    }
+
+    @Test
+    fun testPcmInput_MatchesFloatInputForEveryEncoding() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val inputRate = 16000
+        val input = FloatArray(inputRate / 100 * 50 + 37) { i -> audioData[i] / 32768.0f }
+
+        val expected = mutableListOf<Float>()
+        AudxDenoiser.Builder()
+            .inputSampleRate(inputRate)
+            .onProcessedFloatAudio { audio, _ -> expected.addAll(audio.toList()) }
+            .build().use {
+                it.processChunk(input)
+                it.flush()
+            }
+
+        for (encoding in AudxDenoiser.PcmEncoding.values()) {
+            val bytes = encoding.bytesPerSample
+            val pcm = ByteBuffer.allocate(input.size * bytes).order(ByteOrder.LITTLE_ENDIAN)
+            for (x in input) {
+                // Input is 16-bit, so it is exact in every encoding
+                val v = (x * 32768.0f).toInt() shl 16
+                if (encoding == AudxDenoiser.PcmEncoding.PCM_24BIT_PACKED) {
+                    val s24 = v shr 8
+                    pcm.put(s24.toByte()).put((s24 shr 8).toByte()).put((s24 shr 16).toByte())
+                } else {
+                    pcm.putInt(if (encoding == AudxDenoiser.PcmEncoding.PCM_32BIT) v else v shr 8)
+                }
+            }
+
+            val output = ByteBuffer.allocate(input.size * bytes).order(ByteOrder.LITTLE_ENDIAN)
+            AudxDenoiser.Builder()
+                .inputSampleRate(inputRate)
+                .onProcessedPcmAudio(encoding) { audio, _ -> output.put(audio) }
+                .build().use {
+                    val data = pcm.array()
+                    it.processChunk(data.copyOfRange(0, 1000 * bytes))  // Split mid-frame
+                    it.processChunk(data.copyOfRange(1000 * bytes, data.size))
+                    it.flush()
+                }
+            assertEquals("$encoding output size", 0, output.remaining())
+
+            output.flip()
+            for (i in input.indices) {
+                val actual = when (encoding) {
+                    AudxDenoiser.PcmEncoding.PCM_24BIT_PACKED -> {
+                        val b0 = output.get().toInt() and 0xff
+                        val b1 = output.get().toInt() and 0xff
+                        val b2 = output.get().toInt()
+                        ((b2 shl 16) or (b1 shl 8) or b0) / 8388608.0f
+                    }
+                    AudxDenoiser.PcmEncoding.PCM_24BIT_IN_32 -> output.getInt() / 8388608.0f
+                    AudxDenoiser.PcmEncoding.PCM_32BIT -> output.getInt() / 2147483648.0f
+                }
+                val expectedSample = expected[i].coerceIn(-1.0f, 1.0f)
+                assertTrue("$encoding sample $i: $actual vs $expectedSample",
+                    Math.abs(actual - expectedSample) <= 1.0f / 8388608.0f)
+            }
+        }
+    }
+
+    @Test
+    fun testFloatOutput_RejectedWithPipelinedOrBothCallbacks() {
+        val builders = listOf(
+            AudxDenoiser.Builder().pipelined(true).onProcessedFloatAudio { _, _ -> },
+            AudxDenoiser.Builder()
+                .onProcessedAudio { _, _ -> }
+                .onProcessedFloatAudio { _, _ -> }
+        )
+        for (builder in builders) {
+            try {
+                builder.build().destroy()
+                fail("Builder should be rejected")
+            } catch (e: IllegalArgumentException) {
+                // Expected
+            }
+        }
+    }
+
+    // ==================== Band Feature Tests ====================
+
+    @Test
+    fun testBandFeatures_PreallocatedAndConsistentAcrossInputTypes() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val inputRate = 16000
+        val frame = inputRate / 100
+        val input = audioData.copyOfRange(0, frame * 50)
+
+        suspend fun features(feed: suspend (AudxDenoiser) -> Unit): List<FloatArray> {
+            val frames = mutableListOf<FloatArray>()
+            val arrays = mutableSetOf<Int>()
+            AudxDenoiser.Builder()
+                .inputSampleRate(inputRate)
+                .bandFeatures(true)
+                .onProcessedFloatAudio { _, result ->
+                    val features = result.bandFeatures!!
+                    arrays.add(System.identityHashCode(features))
+                    frames.add(features.copyOf())
+                }
+                .build().use { feed(it) }
+            assertEquals("One preallocated array", 1, arrays.size)
+            return frames
+        }
+
+        val fromShorts = features { it.processChunk(input) }
+        val fromFloats = features {
+            it.processChunk(FloatArray(input.size) { i -> input[i] / 32768.0f })
+        }
+        assertEquals(50, fromShorts.size)
+        assertEquals(50, fromFloats.size)
+
+        for (f in fromShorts.indices) {
+            val a = fromShorts[f]
+            val b = fromFloats[f]
+            assertEquals(AudxDenoiser.BAND_FEATURES_SIZE, a.size)
+            for (band in 0 until AudxDenoiser.BAND_COUNT) {
+                assertTrue("Frame $f band $band energy", a[band] >= 0.0f && a[band].isFinite())
+            }
+            for (i in AudxDenoiser.BAND_COUNT until AudxDenoiser.BAND_FEATURES_SIZE) {
+                // Cepstra are log-domain, so int16 rounding barely moves them
+                assertEquals("Frame $f feature $i", a[i], b[i], 0.05f)
+            }
+        }
+
+        // Silence comes out silent: every band sits on RNNoise's log floor
+        var silent: FloatArray? = null
+        AudxDenoiser.Builder()
+            .bandFeatures(true)
+            .onProcessedAudio { _, result -> silent = result.bandFeatures!!.copyOf() }
+            .build().use { it.processChunk(ShortArray(480 * 3)) }
+        val floorC0 = (-2.0 * Math.sqrt(AudxDenoiser.BAND_COUNT.toDouble()) - 12.0).toFloat()
+        assertEquals(floorC0, silent!![AudxDenoiser.BAND_COUNT], 1e-3f)
+
+        // Off by default
+        var result: DenoiserResult? = null
+        AudxDenoiser.Builder()
+            .onProcessedAudio { _, r -> result = r }
+            .build().use { it.processChunk(ShortArray(480)) }
+        assertNull(result!!.bandFeatures)
+
+        try {
+            AudxDenoiser.Builder().pipelined(true).bandFeatures(true)
+                .onProcessedAudio { _, _ -> }.build().destroy()
+            fail("Band features should be rejected in pipelined mode")
+        } catch (e: IllegalArgumentException) {
+            // Expected
+        }
+    }
+
+    @Test
+    fun testMeasuredBandGains_TrackDenoisingAndNoiseFloor() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val input = audioData.copyOfRange(0, 480 * 100)
+
+        val gains = mutableListOf<FloatArray>()
+        var features: FloatArray? = null
+        AudxDenoiser.Builder()
+            .measuredBandGains(true)
+            .bandFeatures(true)
+            .onProcessedAudio { _, result ->
+                gains.add(result.measuredBandGains!!.copyOf())
+                features = result.bandFeatures
+            }
+            .build().use { it.processChunk(input) }
+
+        assertEquals(100, gains.size)
+        assertNotNull("Gains and features can be combined", features)
+        for ((f, frame) in gains.withIndex()) {
+            assertEquals(AudxDenoiser.MEASURED_GAINS_SIZE, frame.size)
+            for (band in 0 until AudxDenoiser.BAND_COUNT) {
+                // Measured energy ratios: never negative, not clamped at 1
+                assertTrue("Frame $f band $band gain ${frame[band]}",
+                    frame[band].isFinite() && frame[band] >= 0.0f)
+            }
+            assertTrue(frame[AudxDenoiser.MEASURED_GAINS_SNR_DB].isFinite())
+            assertTrue(frame[AudxDenoiser.MEASURED_GAINS_NOISE_FLOOR_DB] <= 0.0f)
+        }
+
+        // Noise input: the denoiser removes energy, so the floor is well above
+        // silence once it has settled
+        val settled = gains.last()
+        assertTrue("Noise floor ${settled[AudxDenoiser.MEASURED_GAINS_NOISE_FLOOR_DB]} dB",
+            settled[AudxDenoiser.MEASURED_GAINS_NOISE_FLOOR_DB] > -90.0f)
+        val meanGain = settled.copyOfRange(0, AudxDenoiser.BAND_COUNT).average()
+        assertTrue("Mean gain $meanGain on noise", meanGain < 1.0)
+    }
+
+    // ==================== State Snapshot Tests ====================
+
+    private fun assertRestoredOutputIdentical(
+        inputRate: Int,
+        floatInput: Boolean = false,
+        configureSource: AudxDenoiser.Builder.() -> Unit = {}
+    ) = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val frameSize = inputRate / 100
+        val warmup = audioData.copyOfRange(0, frameSize * 200)
+        val tail = audioData.copyOfRange(frameSize * 200, frameSize * 300)
+
+        // Float streams are fed samples off the 16-bit grid and compared as
+        // floats, so any rounding in the saved history shows up
+        fun builder(output: MutableList<Float>) = AudxDenoiser.Builder()
+            .inputSampleRate(inputRate)
+            .collectStatistics(true)
+            .apply {
+                if (floatInput) {
+                    onProcessedFloatAudio { audio, _ -> output.addAll(audio.toList()) }
+                } else {
+                    onProcessedAudio { audio, _ -> output.addAll(audio.map { it.toFloat() }) }
+                }
+            }
+
+        suspend fun AudxDenoiser.feed(samples: ShortArray) = if (floatInput) {
+            processChunk(FloatArray(samples.size) { i -> samples[i] * 0.7f / 32768.0f })
+        } else {
+            processChunk(samples)
+        }
+
+        val original = mutableListOf<Float>()
+        val resumed = mutableListOf<Float>()
+        val source = builder(original).apply(configureSource).build()
+        val target = builder(resumed).build()
+
+        try {
+            source.feed(warmup)
+            original.clear()
+            target.restoreState(source.saveState())
+            assertEquals("The saved resampling quality is restored",
+                source.getStats()?.resampleQuality, target.getStats()?.resampleQuality)
+
+            source.feed(tail)
+            target.feed(tail)
+
+            assertEquals(tail.size, resumed.size)
+            assertTrue("Output after restore should be bit-identical",
+                original.toFloatArray().contentEquals(resumed.toFloatArray()))
+        } finally {
+            source.destroy()
+            target.destroy()
+        }
+    }
+
+    @Test
+    fun testStateRestore_48kHz_BitIdentical() = assertRestoredOutputIdentical(48000)
+
+    @Test
+    fun testStateRestore_16kHz_BitIdentical() = assertRestoredOutputIdentical(16000)
+
+    @Test
+    fun testStateRestore_FloatInput_BitIdentical() {
+        assertRestoredOutputIdentical(48000, floatInput = true)
+        assertRestoredOutputIdentical(16000, floatInput = true)
+    }
+
+    @Test
+    fun testStateRestore_AfterAdaptiveQualityChange_BitIdentical() =
+        // Adaptive quality moves the source from 10 to 6 while the target is
+        // built at the default 4; a single-level range keeps it there
+        assertRestoredOutputIdentical(16000) {
+            resampleQuality(AudxDenoiser.RESAMPLER_QUALITY_MAX)
+            adaptiveResampleQuality(minQuality = 6, maxQuality = 6)
+        }
+
+    @Test
+    fun testStateRestore_RejectsMismatchedBlob() = runBlocking {
+        val source = AudxDenoiser.Builder()
+            .inputSampleRate(16000)
+            .onProcessedAudio { _, _ -> }
+            .build()
+        audxDenoiser = AudxDenoiser.Builder()
+            .onProcessedAudio { _, _ -> }
+            .build()
+
+        try {
+            val state = source.saveState()
+            try {
+                audxDenoiser?.restoreState(state)
+                fail("Restoring a 16kHz state into a 48kHz denoiser should fail")
+            } catch (e: IllegalArgumentException) {
+                // Expected
+            }
+            try {
+                audxDenoiser?.restoreState(ByteArray(16))
+                fail("Restoring garbage should fail")
+            } catch (e: IllegalArgumentException) {
+                // Expected
+            }
+        } finally {
+            source.destroy()
+        }
+    }
+
+    // ==================== Pipelined Mode Tests ====================
+
+    private fun denoiseStream(input: ShortArray, inputRate: Int, pipelined: Boolean): ShortArray {
+        val output = mutableListOf<Short>()
+        val denoiser = AudxDenoiser.Builder()
+            .inputSampleRate(inputRate)
+            .pipelined(pipelined)
+            .onProcessedAudio { audio, _ -> output.addAll(audio.toList()) }
+            .build()
+        runBlocking {
+            denoiser.processChunk(input)
+            denoiser.flush()
+        }
+        denoiser.destroy()
+        return output.toShortArray()
+    }
+
+    @Test
+    fun testPipelined_OutputDelayedByOneFrame() {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val inputRate = 16000
+        val frameSize = inputRate / 100
+        val input = audioData.copyOfRange(0, frameSize * 50)
+
+        val reference = denoiseStream(input, inputRate, pipelined = false)
+        val pipelined = denoiseStream(input, inputRate, pipelined = true)
+
+        assertEquals("flush() should drain the pipeline", reference.size + frameSize, pipelined.size)
+        assertTrue("First pipelined frame should be silence",
+            pipelined.copyOfRange(0, frameSize).all { it == 0.toShort() })
+        assertTrue("Pipelined output should be the reference delayed by one frame",
+            reference.contentEquals(pipelined.copyOfRange(frameSize, pipelined.size)))
+    }
+
+    @Test
+    fun testPipelined_FlushDrainsPartialFrame() {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val frameSize = AudxDenoiser.FRAME_SIZE
+        val input = audioData.copyOfRange(0, frameSize * 10 + 100)
+
+        val reference = denoiseStream(input, AudxDenoiser.SAMPLE_RATE, pipelined = false)
+        val pipelined = denoiseStream(input, AudxDenoiser.SAMPLE_RATE, pipelined = true)
+
+        assertEquals(input.size, reference.size)
+        assertEquals(input.size + frameSize, pipelined.size)
+        assertTrue(reference.contentEquals(pipelined.copyOfRange(frameSize, pipelined.size)))
+    }
+
+    // ==================== Pool Tests ====================
+
+    @Test
+    fun testPool_ReusedDenoiserMatchesFreshOne() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val inputRate = 16000
+        val input = audioData.copyOfRange(0, inputRate / 100 * 100)
+        val builder = AudxDenoiser.Builder().inputSampleRate(inputRate).collectStatistics(true)
+
+        val reference = mutableListOf<Short>()
+        val fresh = builder.onProcessedAudio { audio, _ -> reference.addAll(audio.toList()) }.build()
+        fresh.processChunk(input)
+        fresh.destroy()
+
+        builder.onProcessedAudio(null)
+        builder.buildPool(size = 1).use { pool ->
+            repeat(3) { round ->
+                val output = mutableListOf<Short>()
+                val denoiser = pool.acquire { audio, _ -> output.addAll(audio.toList()) }
+                denoiser.processChunk(input)
+                assertEquals(100, denoiser.getStats()?.frameProcessed)
+                denoiser.destroy()
+
+                assertTrue("Round $round output should match a fresh denoiser",
+                    reference.toShortArray().contentEquals(output.toShortArray()))
+            }
+        }
+    }
+
+    @Test
+    fun testPool_AcquireIsFastAndFallsBackWhenExhausted() {
+        AudxDenoiser.Builder().buildPool(size = 2).use { pool ->
+            val start = System.nanoTime()
+            val first = pool.acquire()
+            val second = pool.acquire()
+            val acquireMs = (System.nanoTime() - start) / 2 / 1_000_000.0
+
+            // Exhausted: a regular denoiser is created instead
+            val third = pool.acquire()
+
+            assertTrue("Pooled acquire took ${"%.3f".format(acquireMs)}ms", acquireMs < 5.0)
+            listOf(first, second, third).forEach { it.destroy() }
+        }
+    }
+
+    @Test
+    fun testPool_ReleaseUndoesRestoredQualityAndStageTiming() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val inputRate = 16000
+        val input = audioData.copyOfRange(0, inputRate / 100 * 30)
+        val builder = AudxDenoiser.Builder()
+            .inputSampleRate(inputRate)
+            .resampleQuality(AudxDenoiser.RESAMPLER_QUALITY_VOIP)
+            .collectStatistics(true)
+
+        // Snapshot saved at another quality
+        val source = AudxDenoiser.Builder()
+            .inputSampleRate(inputRate)
+            .resampleQuality(AudxDenoiser.RESAMPLER_QUALITY_MAX)
+            .onProcessedAudio { _, _ -> }
+            .build()
+        source.processChunk(input)
+        val snapshot = source.saveState()
+        source.destroy()
+
+        val reference = mutableListOf<Short>()
+        val fresh = builder.onProcessedAudio { audio, _ -> reference.addAll(audio.toList()) }.build()
+        fresh.processChunk(input)
+        val freshQuality = fresh.getStats()?.resampleQuality
+        fresh.destroy()
+
+        builder.onProcessedAudio(null)
+        builder.buildPool(size = 1).use { pool ->
+            val first = pool.acquire { _, _ -> }
+            first.restoreState(snapshot)
+            first.setStageTimingEnabled(true)
+            first.processChunk(input)
+            assertEquals(AudxDenoiser.RESAMPLER_QUALITY_MAX, first.getStats()?.resampleQuality)
+            first.destroy()
+
+            val output = mutableListOf<Short>()
+            val second = pool.acquire { audio, _ -> output.addAll(audio.toList()) }
+            second.processChunk(input)
+            assertEquals("Quality should be back to the pool's", freshQuality,
+                second.getStats()?.resampleQuality)
+            assertEquals("Stage timing should be off again", 0,
+                second.getStageTimings()?.denoise?.frames)
+            second.destroy()
+
+            assertTrue("Output should match a fresh denoiser",
+                reference.toShortArray().contentEquals(output.toShortArray()))
+        }
+    }
+
+    @Test
+    fun testPool_CloseWhileInUse_DenoiserStaysUsable() = runBlocking {
+        val pool = AudxDenoiser.Builder().buildPool(size = 1)
+        var frames = 0
+        val denoiser = pool.acquire { _, _ -> frames++ }
+        pool.close()
+
+        denoiser.processChunk(ShortArray(AudxDenoiser.FRAME_SIZE * 2))
+        denoiser.destroy()
+        assertEquals(2, frames)
+    }
+
+    @Test
+    fun testPool_AcquireFloat_MatchesFreshFloatDenoiser() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val inputRate = 16000
+        val input = audioData.copyOfRange(0, inputRate / 100 * 50)
+        val builder = AudxDenoiser.Builder().inputSampleRate(inputRate)
+
+        val reference = mutableListOf<Float>()
+        val fresh = builder.onProcessedFloatAudio { audio, _ -> reference.addAll(audio.toList()) }.build()
+        fresh.processChunk(input)
+        fresh.destroy()
+
+        builder.onProcessedFloatAudio(null)
+        builder.buildPool(size = 1).use { pool ->
+            val output = mutableListOf<Float>()
+            val denoiser = pool.acquireFloat { audio, _ -> output.addAll(audio.toList()) }
+            denoiser.processChunk(input)
+            denoiser.destroy()
+
+            assertTrue("Pooled float output should match a fresh denoiser",
+                reference.toFloatArray().contentEquals(output.toFloatArray()))
+        }
+    }
+
+    @Test(expected = IllegalArgumentException::class)
+    fun testPool_BuilderCallbackRejected() {
+        AudxDenoiser.Builder()
+            .onProcessedFloatAudio { _, _ -> }
+            .buildPool(size = 1)
+    }
+
+    // ==================== Offline Denoising Tests ====================
+
+    private suspend fun denoiseSequentially(input: ShortArray): ShortArray {
+        val output = ShortArray(input.size)
+        var written = 0
+        val denoiser = AudxDenoiser.Builder()
+            .onProcessedAudio { audio, _ ->
+                System.arraycopy(audio, 0, output, written, audio.size)
+                written += audio.size
+            }
+            .build()
+        val frameSize = AudxDenoiser.FRAME_SIZE
+        denoiser.processChunk(input.copyOf(input.size / frameSize * frameSize))
+        denoiser.destroy()
+        return output
+    }
+
+    @Test
+    fun testOffline_OutputLengthMatchesInput() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val input = audioData.copyOfRange(0, 48000 * 5 + 123)  // Partial last frame
+
+        val offline = AudxOfflineDenoiser.Builder()
+            .segmentDurationMs(1000)
+            .build()
+        val output = offline.process(input)
+
+        assertEquals("Output should have the input length", input.size, output.size)
+        assertTrue("Output should not be silent", output.any { it != 0.toShort() })
+    }
+
+    @Test
+    fun testOffline_IndependentOfParallelism() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val input = audioData.copyOfRange(0, 48000 * 6)
+
+        fun offline(parallelism: Int) = AudxOfflineDenoiser.Builder()
+            .segmentDurationMs(1000)
+            .parallelism(parallelism)
+            .build()
+
+        val serial = offline(1).process(input)
+        val parallel = offline(4).process(input)
+        assertTrue("Output must not depend on parallelism", serial.contentEquals(parallel))
+    }
+
+    @Test
+    fun testOffline_CloseToSequentialDenoising() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val input = audioData.copyOfRange(0, 48000 * 6)
+
+        val reference = denoiseSequentially(input)
+        val offline = AudxOfflineDenoiser.Builder()
+            .segmentDurationMs(1000)
+            .preRollMs(500)
+            .build()
+            .process(input)
+
+        var errorEnergy = 0.0
+        var referenceEnergy = 0.0
+        for (i in input.indices) {
+            val diff = (offline[i] - reference[i]).toDouble()
+            errorEnergy += diff * diff
+            referenceEnergy += reference[i].toDouble() * reference[i]
+        }
+        assertTrue(
+            "Segmented output should match sequential output within 10% energy " +
+                    "(got ${errorEnergy / referenceEnergy})",
+            errorEnergy < 0.1 * referenceEnergy
+        )
+    }
+
+    @Test
+    fun testOffline_FileMatchesInMemory() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        val input = audioData.copyOfRange(0, 48000 * 5 + 123)  // Partial last frame
+        val offline = AudxOfflineDenoiser.Builder()
+            .segmentDurationMs(1000)
+            .parallelism(2)
+            .build()
+
+        val inFile = File.createTempFile("offline_in", ".pcm", context.cacheDir)
+        val outFile = File.createTempFile("offline_out", ".pcm", context.cacheDir)
+        try {
+            val bytes = ByteBuffer.allocate(input.size * 2).order(ByteOrder.LITTLE_ENDIAN)
+            bytes.asShortBuffer().put(input)
+            inFile.writeBytes(bytes.array())
+            outFile.writeBytes(ByteArray(input.size * 4))  // Longer than the output
+
+            offline.processFile(inFile, outFile)
+
+            val written = outFile.readBytes()
+            assertEquals("Output file should have the input length", input.size * 2, written.size)
+            val fromFile = ShortArray(input.size)
+            ByteBuffer.wrap(written).order(ByteOrder.LITTLE_ENDIAN).asShortBuffer().get(fromFile)
+            assertTrue("Streamed file output should match in-memory processing",
+                offline.process(input).contentEquals(fromFile))
+        } finally {
+            inFile.delete()
+            outFile.delete()
+        }
+    }
+
+    @Test
+    fun testOffline_InvalidConfiguration_Throws() {
+        try {
+            AudxOfflineDenoiser.Builder().preRollMs(10).crossfadeMs(20).build()
+            fail("Crossfade longer than the pre-roll should be rejected")
+        } catch (e: IllegalArgumentException) {
+            assertTrue(e.message?.contains("crossfadeMs") == true)
+        }
+        try {
+            AudxOfflineDenoiser.Builder()
+                .denoiser(AudxDenoiser.Builder().inputSampleRate(16000).adaptiveResampleQuality())
+                .build()
+            fail("Adaptive quality should be rejected")
+        } catch (e: IllegalArgumentException) {
+            assertTrue(e.message?.contains("Adaptive") == true)
+        }
+    }
+
     // ==================== Resampler Tests ===================
 
     @Test
@@ -933,6 +2006,40 @@ class DenoiserInstrumentedTest {
         assertEquals("RESAMPLER_QUALITY_VOIP should be 3", 3, AudxDenoiser.RESAMPLER_QUALITY_VOIP)
     }
 
+    @Test
+    fun testAdaptiveQuality_StaysInRangeAndIsReported() = runBlocking {
+        val audioData = loadPcmAudioFromRaw(R.raw.noise_audio)
+        audxDenoiser = AudxDenoiser.Builder()
+            .inputSampleRate(16000)
+            .resampleQuality(AudxDenoiser.RESAMPLER_QUALITY_MAX)
+            .adaptiveResampleQuality(minQuality = 2, maxQuality = 6)
+            .collectStatistics(true)
+            .onProcessedAudio { _, _ -> }
+            .build()
+
+        assertEquals("Starting quality is clamped to the range", 6, audxDenoiser?.getStats()?.resampleQuality)
+
+        audxDenoiser?.processChunk(audioData.copyOfRange(0, 16000 * 3))
+        val quality = audxDenoiser?.getStats()?.resampleQuality ?: -1
+        assertTrue("Quality $quality should stay within 2..6", quality in 2..6)
+
+        // Fixed quality is reported as configured
+        val fixed = AudxDenoiser.Builder()
+            .inputSampleRate(16000)
+            .resampleQuality(AudxDenoiser.RESAMPLER_QUALITY_VOIP)
+            .collectStatistics(true)
+            .build()
+        assertEquals(AudxDenoiser.RESAMPLER_QUALITY_VOIP, fixed.getStats()?.resampleQuality)
+        fixed.destroy()
+
+        try {
+            AudxDenoiser.Builder().adaptiveResampleQuality(5, 3).build()
+            fail("An empty quality range should be rejected")
+        } catch (e: IllegalArgumentException) {
+            // Expected
+        }
+    }
+
     @Test
     fun testDenoiser_WithDefaultSampleRate_NoResampling() = runBlocking {
         // Default is 48kHz, no resampling needed
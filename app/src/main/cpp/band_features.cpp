@@ -0,0 +1,264 @@
+#include "band_features.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr int kFrameSize = AUDX_DEFAULT_FRAME_SIZE;   // 480
+constexpr int kWindowSize = 2 * kFrameSize;           // 960-point real FFT
+constexpr int kFftSize = kFrameSize;                  // ...as a 480-point complex FFT
+constexpr int kFreqSize = kFrameSize + 1;
+
+// kFftSize = 4 * 4 * 2 * 3 * 5, one radix per recursion level
+constexpr int kFactors[] = {4, 4, 2, 3, 5};
+constexpr int kMaxRadix = 5;
+
+// Band edges in 200 Hz units (eband5ms in RNNoise); << kBandShift gives
+// 50 Hz bins of the 20 ms window
+constexpr int kBandEdges[AUDX_NB_BANDS] = {
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 14, 16, 20, 24, 28, 34, 40, 48, 60, 78, 100};
+constexpr int kBandShift = 2;
+
+// Floor added to band energies before dividing or taking logs, as in
+// RNNoise's log energies
+constexpr float kEnergyFloor = 1e-2f;
+
+// Total band energy of a full-scale sine, the 0 dB reference of the noise floor
+constexpr float kFullScaleEnergy = 32768.0f * 32768.0f / 8.0f;
+
+// Noise floor rise per 10 ms frame (about 200 ms time constant)
+constexpr float kNoiseRise = 0.05f;
+
+struct Complex {
+    float r;
+    float i;
+};
+
+inline Complex operator+(Complex a, Complex b) { return {a.r + b.r, a.i + b.i}; }
+inline Complex operator-(Complex a, Complex b) { return {a.r - b.r, a.i - b.i}; }
+inline Complex operator*(Complex a, Complex b) {
+    return {a.r * b.r - a.i * b.i, a.r * b.i + a.i * b.r};
+}
+
+/** Window, FFT twiddles and DCT basis, computed on first use */
+struct Tables {
+    float window[kFrameSize];             // First half; the second is its mirror
+    Complex twiddle[kFftSize];            // exp(-2*pi*i*k/480)
+    Complex real_twiddle[kFreqSize];      // exp(-2*pi*i*k/960), real FFT post-processing
+    float dct[AUDX_NB_BANDS * AUDX_NB_BANDS];
+
+    Tables() {
+        const double pi = M_PI;
+        for (int i = 0; i < kFrameSize; i++) {
+            double s = sin(.5 * pi * (i + .5) / kFrameSize);
+            window[i] = (float) sin(.5 * pi * s * s);
+        }
+        for (int k = 0; k < kFftSize; k++) {
+            double phase = -2.0 * pi * k / kFftSize;
+            twiddle[k] = {(float) cos(phase), (float) sin(phase)};
+        }
+        for (int k = 0; k < kFreqSize; k++) {
+            double phase = -2.0 * pi * k / kWindowSize;
+            real_twiddle[k] = {(float) cos(phase), (float) sin(phase)};
+        }
+        // dct[j * NB + i]: coefficient i, band j, orthonormal scaling folded in
+        const double scale = sqrt(2.0 / AUDX_NB_BANDS);
+        for (int j = 0; j < AUDX_NB_BANDS; j++) {
+            for (int i = 0; i < AUDX_NB_BANDS; i++) {
+                double c = cos((j + .5) * i * pi / AUDX_NB_BANDS) * scale;
+                if (i == 0) {
+                    c *= sqrt(.5);
+                }
+                dct[j * AUDX_NB_BANDS + i] = (float) c;
+            }
+        }
+    }
+};
+
+const Tables &tables() {
+    static const Tables instance;
+    return instance;
+}
+
+/** Multiply by -i */
+inline Complex rotate(Complex a) { return {a.i, -a.r}; }
+
+/**
+ * Mixed-radix decimation-in-time FFT of n points read every stride samples
+ * from in, written contiguously to out
+ */
+void fft(const Complex *in, int stride, int n, const int *factors,
+         const Complex *twiddle, Complex *out) {
+    const int p = factors[0];
+    const int m = n / p;
+    for (int r = 0; r < p; r++) {
+        if (m == 1) {
+            out[r] = in[r * stride];
+        } else {
+            fft(in + r * stride, stride * p, m, factors + 1, twiddle, out + r * m);
+        }
+    }
+
+    // Combine the p sub-transforms: out[q*m + k] = sum_r W_n^(r(k + qm)) sub_r[k]
+    const int step = kFftSize / n;
+    Complex roots[kMaxRadix];     // p-th roots of unity
+    for (int j = 0; j < p; j++) {
+        roots[j] = twiddle[j * (kFftSize / p)];
+    }
+    Complex a[kMaxRadix];
+    for (int k = 0; k < m; k++) {
+        a[0] = out[k];
+        for (int r = 1; r < p; r++) {
+            a[r] = out[r * m + k] * twiddle[r * k * step];
+        }
+        if (p == 2) {
+            out[k] = a[0] + a[1];
+            out[m + k] = a[0] - a[1];
+        } else if (p == 4) {
+            const Complex s02 = a[0] + a[2];
+            const Complex d02 = a[0] - a[2];
+            const Complex s13 = a[1] + a[3];
+            const Complex d13 = rotate(a[1] - a[3]);
+            out[k] = s02 + s13;
+            out[m + k] = d02 + d13;
+            out[2 * m + k] = s02 - s13;
+            out[3 * m + k] = d02 - d13;
+        } else {
+            // Odd radices: direct DFT
+            for (int q = 0; q < p; q++) {
+                Complex sum = a[0];
+                int root = 0;         // r * q mod p
+                for (int r = 1; r < p; r++) {
+                    root += q;
+                    if (root >= p) {
+                        root -= p;
+                    }
+                    sum = sum + a[r] * roots[root];
+                }
+                out[q * m + k] = sum;
+            }
+        }
+    }
+}
+
+/** Power spectrum of the windowed 960-sample buffer, scaled like RNNoise's forward transform */
+void power_spectrum(const float *x, float *power) {
+    const Tables &t = tables();
+
+    // Even samples as the real part, odd ones as the imaginary part
+    Complex packed[kFftSize];
+    Complex z[kFftSize];
+    memcpy(packed, x, sizeof(packed));
+    fft(packed, 1, kFftSize, kFactors, t.twiddle, z);
+
+    const float scale = 1.0f / kWindowSize;
+    for (int k = 0; k < kFreqSize; k++) {
+        Complex zk = z[k % kFftSize];
+        Complex zc = z[(kFftSize - k) % kFftSize];
+        zc.i = -zc.i;
+        Complex even = {(zk.r + zc.r) * .5f, (zk.i + zc.i) * .5f};
+        Complex diff = {(zk.r - zc.r) * .5f, (zk.i - zc.i) * .5f};
+        Complex odd = rotate(diff);        // diff / i
+        Complex bin = even + t.real_twiddle[k] * odd;
+        power[k] = (bin.r * bin.r + bin.i * bin.i) * scale * scale;
+    }
+}
+
+/** Window the buffer, whose second half holds the new frame, and fill energy */
+void analyze_window(BandAnalyzer *analyzer, float *x, float *energy) {
+    const Tables &t = tables();
+    memcpy(x, analyzer->memory, sizeof(analyzer->memory));
+    memcpy(analyzer->memory, x + kFrameSize, sizeof(analyzer->memory));
+    for (int i = 0; i < kFrameSize; i++) {
+        x[i] *= t.window[i];
+        x[kWindowSize - 1 - i] *= t.window[i];
+    }
+
+    float power[kFreqSize];
+    power_spectrum(x, power);
+
+    // Triangular bands centred on each edge (compute_band_energy() in RNNoise)
+    std::fill(energy, energy + AUDX_NB_BANDS, 0.0f);
+    for (int b = 0; b < AUDX_NB_BANDS - 1; b++) {
+        const int start = kBandEdges[b] << kBandShift;
+        const int width = (kBandEdges[b + 1] - kBandEdges[b]) << kBandShift;
+        for (int j = 0; j < width; j++) {
+            const float frac = (float) j / width;
+            energy[b] += (1.0f - frac) * power[start + j];
+            energy[b + 1] += frac * power[start + j];
+        }
+    }
+    // The outer bands only get one half of a triangle
+    energy[0] *= 2.0f;
+    energy[AUDX_NB_BANDS - 1] *= 2.0f;
+}
+
+}  // namespace
+
+void band_analyzer_reset(BandAnalyzer *analyzer) {
+    memset(analyzer->memory, 0, sizeof(analyzer->memory));
+}
+
+void band_analyze(BandAnalyzer *analyzer, const float *frame, float *energy) {
+    float x[kWindowSize];
+    memcpy(x + kFrameSize, frame, kFrameSize * sizeof(float));
+    analyze_window(analyzer, x, energy);
+}
+
+void band_analyze(BandAnalyzer *analyzer, const int16_t *frame, float *energy) {
+    float x[kWindowSize];
+    pcm_int16_to_float(frame, x + kFrameSize, kFrameSize);
+    analyze_window(analyzer, x, energy);
+}
+
+void band_cepstrum(const float *energy, float *cepstrum) {
+    const Tables &t = tables();
+
+    // Log energies with RNNoise's floor: nothing more than 7 decades under
+    // the loudest band so far, or falling faster than 1.5 per band
+    float log_energy[AUDX_NB_BANDS];
+    float log_max = -2.0f;
+    float follow = -2.0f;
+    for (int b = 0; b < AUDX_NB_BANDS; b++) {
+        float ly = log10f(kEnergyFloor + energy[b]);
+        ly = std::max(log_max - 7.0f, std::max(follow - 1.5f, ly));
+        log_max = std::max(log_max, ly);
+        follow = std::max(follow - 1.5f, ly);
+        log_energy[b] = ly;
+    }
+
+    for (int i = 0; i < AUDX_NB_BANDS; i++) {
+        float sum = 0.0f;
+        for (int j = 0; j < AUDX_NB_BANDS; j++) {
+            sum += log_energy[j] * t.dct[j * AUDX_NB_BANDS + i];
+        }
+        cepstrum[i] = sum;
+    }
+    cepstrum[0] -= 12.0f;
+    cepstrum[1] -= 4.0f;
+}
+
+void band_gains(const float *input_energy, const float *output_energy,
+                float *noise_energy, BandGains *gains) {
+    float speech = 0.0f;
+    float removed = 0.0f;
+    for (int b = 0; b < AUDX_NB_BANDS; b++) {
+        const float in = input_energy[b];
+        const float out = output_energy[b];
+        gains->gain[b] = sqrtf(out / (in + kEnergyFloor));
+        speech += out;
+        removed += std::max(in - out, 0.0f);
+    }
+
+    float &noise = *noise_energy;
+    if (noise < 0.0f || removed < noise) {
+        noise = removed;
+    } else {
+        noise += kNoiseRise * (removed - noise);
+    }
+
+    gains->snr_db = 10.0f * log10f((speech + kEnergyFloor) / (noise + kEnergyFloor));
+    gains->noise_floor_db = 10.0f * log10f((noise + kEnergyFloor) / kFullScaleEnergy);
+}
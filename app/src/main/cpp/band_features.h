@@ -0,0 +1,87 @@
+#ifndef AUDX_BAND_FEATURES_H
+#define AUDX_BAND_FEATURES_H
+
+#include <cstdint>
+
+extern "C" {
+#include "audx/common.h"
+}
+
+/**
+ * Per-frame spectral analysis on RNNoise's band layout
+ *
+ * Reproduces the analysis RNNoise runs on its input: a 20 ms Vorbis-windowed
+ * frame (the previous 10 ms frame plus the current one), a 960-point real
+ * FFT, and the energy of 22 triangular bands on the 5 ms (200 Hz) Opus band
+ * edges up to 20 kHz. band_cepstrum() turns the energies into RNNoise's
+ * cepstral features (log10 energies with its noise floor, DCT-II, the same
+ * offsets on the first two coefficients). The pitch features are not
+ * reproduced. band_gains() compares the bands before and after denoising.
+ *
+ * Frames are 48kHz at int16 scale, like the denoiser's processing buffer.
+ */
+
+/** Number of bands (NB_BANDS in RNNoise) */
+constexpr int AUDX_NB_BANDS = 22;
+
+/**
+ * Analysis window memory of one signal. Zero-initialized is the reset
+ * state, so it can live in the stream arena.
+ */
+struct BandAnalyzer {
+    float memory[AUDX_DEFAULT_FRAME_SIZE];    // Previous frame, first half of the window
+};
+
+/** Features of one frame, in the order they are handed to Kotlin */
+struct BandFeatures {
+    float band_energy[AUDX_NB_BANDS];
+    float cepstrum[AUDX_NB_BANDS];
+};
+
+/**
+ * What the denoiser did to one frame, from the band energies of its input
+ * and output
+ */
+struct BandGains {
+    float gain[AUDX_NB_BANDS];    // sqrt(output / input energy), not clamped
+    float snr_db;                 // Output energy over the noise floor
+    float noise_floor_db;         // Tracked removed energy, dB relative to a full-scale sine
+};
+
+/** Clear the window memory, as for a new stream */
+void band_analyzer_reset(BandAnalyzer *analyzer);
+
+/**
+ * @brief Band energies of one frame
+ *
+ * Advances the window memory, so call once per frame in stream order.
+ *
+ * @param frame   AUDX_DEFAULT_FRAME_SIZE samples
+ * @param energy  AUDX_NB_BANDS band energies
+ */
+void band_analyze(BandAnalyzer *analyzer, const float *frame, float *energy);
+void band_analyze(BandAnalyzer *analyzer, const int16_t *frame, float *energy);
+
+/**
+ * @brief RNNoise's cepstral features from AUDX_NB_BANDS band energies
+ */
+void band_cepstrum(const float *energy, float *cepstrum);
+
+/**
+ * @brief Per-band gains, SNR and noise floor of one frame
+ *
+ * Each gain is sqrt(output / input) of the band energy, measured from the
+ * audio rather than taken from RNNoise, and may exceed 1.
+ * The energy removed from the frame is its noise estimate. noise_energy
+ * tracks it across frames: it follows drops at once and rises with a time
+ * constant of about 200 ms, so speech does not lift the floor. Pass the same
+ * variable every frame, negative before the first one.
+ *
+ * @param input_energy   Band energies of the denoiser input
+ * @param output_energy  Band energies of the matching output
+ * @param noise_energy   Noise floor tracker state
+ */
+void band_gains(const float *input_energy, const float *output_energy,
+                float *noise_energy, BandGains *gains);
+
+#endif // AUDX_BAND_FEATURES_H
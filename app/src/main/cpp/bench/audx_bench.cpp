@@ -0,0 +1,691 @@
+/**
+ * Host benchmark driver for the audx processing pipeline.
+ *
+ * Drives the same stream code the JNI layer uses (stream.cpp): upsampler,
+ * denoiser, downsampler, one 10 ms frame at a time, and reports per-frame
+ * processing time for each input rate / resampler quality combination.
+ *
+ * Usage:
+ *   audx_bench [--input FILE] [--rate HZ] [--quality Q] [--frames N] [--stages]
+ *              [--trace OUT.json] [--pipelined]
+ *   audx_bench --perf [--input FILE] [--rate HZ] [--quality Q] [--frames N]
+ *   audx_bench --interleave STREAMS [--input FILE] [--rate HZ] [--quality Q] [--frames N]
+ *   audx_bench --silence-decay [--input FILE] [--rate HZ] [--quality Q]
+ *   audx_bench --train [--input FILE]
+ *
+ * FILE is raw 16-bit mono PCM and is interpreted at each benchmarked rate.
+ * Without --input a synthetic speech-like signal is used. Without --rate or
+ * --quality the driver sweeps 48/16/8 kHz and qualities 0, 4 and 10.
+ * --stages also prints the per-stage time breakdown (to stderr, so the table
+ * on stdout stays machine-readable). --trace writes Chrome trace-event JSON
+ * for every frame (requires AUDX_ENABLE_TRACING). --pipelined runs the
+ * streams in pipelined mode, so the reported time is the calling thread's
+ * share of each frame while inference runs on its own thread.
+ *
+ * --perf (Linux) reads hardware counters around the upsampler, the denoiser
+ * and the downsampler and reports cycles, instructions, IPC, cache misses and
+ * branch misses per frame for each stage, to tell compute-bound stages (high
+ * IPC) from memory-bound ones (low IPC, many cache misses).
+ *
+ * --interleave creates STREAMS streams and feeds them one frame each in turn,
+ * as a server handling many calls does, so each frame starts with the
+ * previous stream's state in cache. It reports per-frame time and, on Linux,
+ * cache and data TLB misses per frame, which is where the layout of a
+ * stream's memory shows.
+ *
+ * --silence-decay is a regression check for subnormal slowdowns: 10 s of
+ * speech followed by 3 minutes of digital silence, reporting the mean frame
+ * time of every 10 s window. It exits non-zero if any silence window is more
+ * than kDecayTolerance times slower than the speech window.
+ *
+ * --train runs the profile-guided optimization training workload instead
+ * (see bench/pgo.sh): 48, 16 and 8 kHz streams at every resampler quality,
+ * alternating speech and digital silence.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "denormal_guard.h"
+#include "stream.h"
+#include "trace.h"
+
+#ifdef __linux__
+#include "perf_counters.h"
+#endif
+
+namespace {
+
+struct BenchConfig {
+    int rate;
+    int quality;
+};
+
+struct BenchOptions {
+    const char *input_path = nullptr;
+    int rate = 0;        // 0 = sweep
+    int quality = -1;    // -1 = sweep
+    int frames = 3000;   // 30 s of audio
+    bool train = false;
+    bool stages = false;
+    const char *trace_path = nullptr;
+    bool perf = false;
+    bool silence_decay = false;
+    bool pipelined = false;
+    int interleave = 0;  // Streams; 0 = single-stream timing
+};
+
+/** Silence-decay check: speech, then a long digital silence */
+constexpr int kDecayWindowFrames = 1000;       // 10 s
+constexpr int kDecaySpeechWindows = 1;
+constexpr int kDecaySilenceWindows = 18;      // 3 minutes
+constexpr double kDecayTolerance = 2.0;
+
+/** Training workload shape: speech, then silence, repeated */
+constexpr int kTrainSpeechFrames = 200;
+constexpr int kTrainSilenceFrames = 100;
+constexpr int kTrainCycles = 2;
+
+/**
+ * Synthetic voiced signal: a harmonic series with a slow syllable envelope,
+ * over a low broadband noise floor.
+ */
+std::vector<int16_t> make_speech_like(int rate, int samples) {
+    std::vector<int16_t> out(samples);
+    uint32_t seed = 0x12345678u;
+    for (int i = 0; i < samples; i++) {
+        double t = (double) i / rate;
+        double f0 = 140.0 + 30.0 * std::sin(2.0 * M_PI * 0.7 * t);
+        double envelope = 0.5 + 0.5 * std::sin(2.0 * M_PI * 3.0 * t);
+        double voiced = 0.0;
+        for (int h = 1; h <= 12 && h * f0 < rate / 2.0; h++) {
+            voiced += std::sin(2.0 * M_PI * h * f0 * t) / h;
+        }
+        seed = seed * 1664525u + 1013904223u;
+        double noise = ((double) (seed >> 16) / 32768.0 - 1.0) * 0.05;
+        double v = (0.3 * envelope * voiced + noise) * 32767.0;
+        out[i] = (int16_t) std::max(-32768.0, std::min(32767.0, v));
+    }
+    return out;
+}
+
+bool load_pcm(const char *path, std::vector<int16_t> &out) {
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr) {
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long bytes = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    out.resize(bytes / sizeof(int16_t));
+    size_t read = fread(out.data(), sizeof(int16_t), out.size(), f);
+    fclose(f);
+    out.resize(read);
+    return !out.empty();
+}
+
+int run_config(const BenchConfig &cfg, const BenchOptions &opts,
+               const std::vector<int16_t> &file_pcm) {
+    struct DenoiserConfig config{};
+    config.model_preset = MODEL_EMBEDDED;
+    config.model_path = nullptr;
+    config.vad_threshold = AUDX_DEFAULT_VAD_THRESHOLD;
+    config.stats_enabled = false;
+
+    int err;
+    NativeHandle *handle = audx_stream_create(&config, cfg.rate, cfg.quality, &err);
+    if (handle == nullptr) {
+        fprintf(stderr, "audx_stream_create(rate=%d, quality=%d) failed: %d\n",
+                cfg.rate, cfg.quality, err);
+        return err;
+    }
+    if (opts.pipelined && (err = audx_stream_start_pipeline(handle)) != AUDX_SUCCESS) {
+        fprintf(stderr, "audx_stream_start_pipeline failed: %d\n", err);
+        audx_stream_destroy(handle);
+        return err;
+    }
+
+    const int frame = handle->resampler_ctx->input_frame_samples;
+    std::vector<int16_t> signal = file_pcm.empty()
+            ? make_speech_like(cfg.rate, frame * opts.frames)
+            : file_pcm;
+    const int available = (int) (signal.size() / frame);
+
+    std::vector<int16_t> output(frame);
+    std::vector<double> frame_us(opts.frames);
+    handle->stage_timers.set_enabled(opts.stages);
+
+    for (int i = 0; i < opts.frames; i++) {
+        const int16_t *in = signal.data() + (size_t) (i % available) * frame;
+        auto start = std::chrono::steady_clock::now();
+        handle->stage_timers.begin_frame();
+        int ret = audx_stream_process(handle, in, output.data(), nullptr);
+        handle->stage_timers.end_frame();
+        auto end = std::chrono::steady_clock::now();
+        if (ret != AUDX_SUCCESS) {
+            fprintf(stderr, "audx_stream_process failed at frame %d: %d\n", i, ret);
+            audx_stream_destroy(handle);
+            return ret;
+        }
+        frame_us[i] = std::chrono::duration<double, std::micro>(end - start).count();
+    }
+
+    StageSummary stages[AUDX_STAGE_COUNT];
+    audx_stream_get_stage_timings(handle, stages);
+    audx_stream_destroy(handle);
+
+    if (opts.stages) {
+        static const char *const kStageNames[AUDX_STAGE_COUNT] = {
+                "array", "upsample", "denoise", "downsample", "marshal", "convert", "analysis"};
+        fprintf(stderr, "rate=%d quality=%d stages (avg_us/max_us):", cfg.rate, cfg.quality);
+        for (int i = 0; i < AUDX_STAGE_COUNT; i++) {
+            if (stages[i].frames > 0) {
+                fprintf(stderr, " %s=%.2f/%.2f", kStageNames[i],
+                        stages[i].avg_ms * 1000.0, stages[i].max_ms * 1000.0);
+            }
+        }
+        fprintf(stderr, "\n");
+    }
+
+    double total = 0.0;
+    for (double us : frame_us) {
+        total += us;
+    }
+    std::sort(frame_us.begin(), frame_us.end());
+    double mean = total / opts.frames;
+    double p50 = frame_us[opts.frames / 2];
+    double p99 = frame_us[(size_t) (opts.frames * 0.99)];
+
+    printf("%6d %7d %8d %10.2f %10.2f %10.2f %8.4f\n", cfg.rate, cfg.quality,
+           opts.frames, mean, p50, p99, mean / 10000.0);
+    return AUDX_SUCCESS;
+}
+
+#ifdef __linux__
+/**
+ * Hardware counters per stage. Mirrors audx_stream_process() with a counter
+ * read between each call, so the JNI-independent stages can be compared.
+ */
+int perf_config(const BenchConfig &cfg, const BenchOptions &opts,
+                const std::vector<int16_t> &file_pcm) {
+    PerfCounters counters;
+    if (!counters.ok()) {
+        fprintf(stderr, "perf_event_open failed: %s\n"
+                        "(no hardware PMU, or check /proc/sys/kernel/perf_event_paranoid)\n", strerror(errno));
+        return AUDX_ERROR_UNSUPPORTED;
+    }
+
+    struct DenoiserConfig config{};
+    config.model_preset = MODEL_EMBEDDED;
+    config.model_path = nullptr;
+    config.vad_threshold = AUDX_DEFAULT_VAD_THRESHOLD;
+    config.stats_enabled = false;
+
+    int err;
+    NativeHandle *handle = audx_stream_create(&config, cfg.rate, cfg.quality, &err);
+    if (handle == nullptr) {
+        fprintf(stderr, "audx_stream_create(rate=%d, quality=%d) failed: %d\n",
+                cfg.rate, cfg.quality, err);
+        return err;
+    }
+
+    ResamplerContext *ctx = handle->resampler_ctx;
+    const int frame = ctx->input_frame_samples;
+    std::vector<int16_t> signal = file_pcm.empty()
+            ? make_speech_like(cfg.rate, frame * opts.frames)
+            : file_pcm;
+    const int available = (int) (signal.size() / frame);
+    std::vector<int16_t> output(frame);
+
+    enum { kUpsample, kDenoise, kDownsample, kStages };
+    static const char *const kStageNames[kStages] = {"upsample", "denoise", "downsample"};
+    PerfSample totals[kStages] = {};
+    int skipped = 0;
+
+    for (int i = 0; i < opts.frames; i++) {
+        const int16_t *in = signal.data() + (size_t) (i % available) * frame;
+        const int16_t *denoise_in = in;
+        int16_t *denoise_out = output.data();
+        // Same floating-point mode as audx_stream_process()
+        ScopedDenormalsOff denormals_off;
+
+        PerfSample t[4];
+        bool read = counters.read_now(&t[0]);
+        if (ctx->needs_resampling) {
+            audx_uint32_t in_len = ctx->input_frame_samples;
+            audx_uint32_t out_len = ctx->output_frame_samples;
+            audx_resample_process(ctx->upsampler, in, &in_len, ctx->resampled_input, &out_len);
+            denoise_in = ctx->resampled_input;
+            denoise_out = ctx->resampled_output;
+        }
+        read = counters.read_now(&t[1]) && read;
+        denoiser_process(handle->denoiser, denoise_in, denoise_out, nullptr);
+        read = counters.read_now(&t[2]) && read;
+        if (ctx->needs_resampling) {
+            audx_uint32_t in_len = ctx->output_frame_samples;
+            audx_uint32_t out_len = ctx->input_frame_samples;
+            audx_resample_process(ctx->downsampler, ctx->resampled_output, &in_len,
+                                  output.data(), &out_len);
+        }
+        read = counters.read_now(&t[3]) && read;
+
+        // A failed read has no sample to subtract; leave the frame out
+        if (!read) {
+            skipped++;
+            continue;
+        }
+        totals[kUpsample] += t[1] - t[0];
+        totals[kDenoise] += t[2] - t[1];
+        totals[kDownsample] += t[3] - t[2];
+    }
+
+    const bool resamples = ctx->needs_resampling;
+    audx_stream_destroy(handle);
+
+    if (skipped == opts.frames) {
+        fprintf(stderr, "Reading the perf counters failed on every frame\n");
+        return AUDX_ERROR_EXTERNAL;
+    }
+    if (skipped > 0) {
+        fprintf(stderr, "Skipped %d frames with a failed counter read\n", skipped);
+    }
+
+    const double n = opts.frames - skipped;
+    for (int s = 0; s < kStages; s++) {
+        if (!resamples && s != kDenoise) {
+            continue;
+        }
+        const PerfSample &t = totals[s];
+        printf("%6d %7d %-10s %12.0f %12.0f %6.2f %10.1f %10.1f\n", cfg.rate, cfg.quality,
+               kStageNames[s], t.cycles / n, t.instructions / n,
+               t.cycles > 0 ? (double) t.instructions / (double) t.cycles : 0.0,
+               t.cache_misses / n, t.branch_misses / n);
+    }
+    return AUDX_SUCCESS;
+}
+#endif
+
+/**
+ * Per-frame time with opts.interleave streams processed round-robin. Cache
+ * and TLB misses cover the whole frame, resamplers included.
+ */
+int interleave_config(const BenchConfig &cfg, const BenchOptions &opts,
+                      const std::vector<int16_t> &file_pcm) {
+    struct DenoiserConfig config{};
+    config.model_preset = MODEL_EMBEDDED;
+    config.model_path = nullptr;
+    config.vad_threshold = AUDX_DEFAULT_VAD_THRESHOLD;
+    config.stats_enabled = false;
+
+    std::vector<NativeHandle *> handles;
+    int ret = AUDX_SUCCESS;
+    for (int s = 0; s < opts.interleave; s++) {
+        NativeHandle *handle = audx_stream_create(&config, cfg.rate, cfg.quality, &ret);
+        if (handle == nullptr) {
+            fprintf(stderr, "audx_stream_create(rate=%d, quality=%d) failed: %d\n",
+                    cfg.rate, cfg.quality, ret);
+            break;
+        }
+        handles.push_back(handle);
+    }
+
+    if (ret == AUDX_SUCCESS) {
+        const int frame = handles[0]->resampler_ctx->input_frame_samples;
+        std::vector<int16_t> signal = file_pcm.empty()
+                ? make_speech_like(cfg.rate, frame * opts.frames)
+                : file_pcm;
+        const int available = (int) (signal.size() / frame);
+        std::vector<int16_t> output(frame);
+        std::vector<double> frame_us((size_t) opts.frames * handles.size());
+
+#ifdef __linux__
+        PerfCounters counters;
+        PerfSample total{};
+        size_t counted = 0;    // Frames with both counter reads
+#endif
+        size_t n = 0;
+        for (int i = 0; i < opts.frames && ret == AUDX_SUCCESS; i++) {
+            // Streams start at different offsets so they do not all see the same audio
+            for (size_t s = 0; s < handles.size(); s++) {
+                const int16_t *in = signal.data() + (size_t) ((i + s * 37) % available) * frame;
+#ifdef __linux__
+                PerfSample before;
+                PerfSample after;
+                bool read = counters.read_now(&before);
+#endif
+                auto start = std::chrono::steady_clock::now();
+                ret = audx_stream_process(handles[s], in, output.data(), nullptr);
+                auto end = std::chrono::steady_clock::now();
+#ifdef __linux__
+                if (counters.read_now(&after) && read) {
+                    total += after - before;
+                    counted++;
+                }
+#endif
+                if (ret != AUDX_SUCCESS) {
+                    fprintf(stderr, "audx_stream_process failed at frame %d: %d\n", i, ret);
+                    break;
+                }
+                frame_us[n++] = std::chrono::duration<double, std::micro>(end - start).count();
+            }
+        }
+
+        if (ret == AUDX_SUCCESS) {
+            double sum = 0.0;
+            for (double us : frame_us) {
+                sum += us;
+            }
+            std::sort(frame_us.begin(), frame_us.end());
+            char cache[16] = "-";
+            char dtlb[16] = "-";
+#ifdef __linux__
+            if (counted > 0) {
+                snprintf(cache, sizeof(cache), "%.1f", total.cache_misses / (double) counted);
+                if (counters.has_dtlb()) {
+                    snprintf(dtlb, sizeof(dtlb), "%.1f", total.dtlb_misses / (double) counted);
+                }
+            }
+#endif
+            printf("%6d %7d %7zu %10.2f %10.2f %10s %10s\n", cfg.rate, cfg.quality,
+                   handles.size(), sum / n, frame_us[(size_t) (n * 0.99)], cache, dtlb);
+        }
+    }
+
+    for (NativeHandle *handle : handles) {
+        audx_stream_destroy(handle);
+    }
+    return ret;
+}
+
+/**
+ * Mean frame time per 10 s window across speech and then silence. Returns
+ * AUDX_ERROR_EXTERNAL if frame time does not stay flat in silence.
+ */
+int decay_config(const BenchConfig &cfg, const std::vector<int16_t> &file_pcm) {
+    struct DenoiserConfig config{};
+    config.model_preset = MODEL_EMBEDDED;
+    config.model_path = nullptr;
+    config.vad_threshold = AUDX_DEFAULT_VAD_THRESHOLD;
+    config.stats_enabled = false;
+
+    int err;
+    NativeHandle *handle = audx_stream_create(&config, cfg.rate, cfg.quality, &err);
+    if (handle == nullptr) {
+        fprintf(stderr, "audx_stream_create(rate=%d, quality=%d) failed: %d\n",
+                cfg.rate, cfg.quality, err);
+        return err;
+    }
+
+    const int frame = handle->resampler_ctx->input_frame_samples;
+    std::vector<int16_t> speech = file_pcm.empty()
+            ? make_speech_like(cfg.rate, frame * kDecayWindowFrames)
+            : file_pcm;
+    const int available = (int) (speech.size() / frame);
+    std::vector<int16_t> silence(frame, 0);
+    std::vector<int16_t> output(frame);
+
+    double speech_us = 0.0;
+    double worst_ratio = 0.0;
+    for (int w = 0; w < kDecaySpeechWindows + kDecaySilenceWindows; w++) {
+        const bool is_speech = w < kDecaySpeechWindows;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kDecayWindowFrames; i++) {
+            const int16_t *in = is_speech
+                    ? speech.data() + (size_t) ((w * kDecayWindowFrames + i) % available) * frame
+                    : silence.data();
+            int ret = audx_stream_process(handle, in, output.data(), nullptr);
+            if (ret != AUDX_SUCCESS) {
+                fprintf(stderr, "audx_stream_process(rate=%d, quality=%d) failed: %d\n",
+                        cfg.rate, cfg.quality, ret);
+                audx_stream_destroy(handle);
+                return ret;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        double mean_us = std::chrono::duration<double, std::micro>(end - start).count()
+                         / kDecayWindowFrames;
+
+        if (is_speech) {
+            speech_us = mean_us;
+        } else {
+            worst_ratio = std::max(worst_ratio, mean_us / speech_us);
+        }
+        printf("%6d %7d %8d %-8s %10.2f\n", cfg.rate, cfg.quality, (w + 1) * 10,
+               is_speech ? "speech" : "silence", mean_us);
+    }
+
+    audx_stream_destroy(handle);
+
+    bool flat = worst_ratio <= kDecayTolerance;
+    printf("# rate=%d quality=%d worst silence/speech ratio %.2f: %s\n", cfg.rate,
+           cfg.quality, worst_ratio, flat ? "ok" : "REGRESSION");
+    return flat ? AUDX_SUCCESS : AUDX_ERROR_EXTERNAL;
+}
+
+/**
+ * Run the PGO training workload for one configuration. Speech exercises the
+ * full-scale paths through the resamplers and the network, silence the
+ * decaying-state paths a real stream spends much of its time in.
+ */
+int train_config(const BenchConfig &cfg, const std::vector<int16_t> &file_pcm) {
+    struct DenoiserConfig config{};
+    config.model_preset = MODEL_EMBEDDED;
+    config.model_path = nullptr;
+    config.vad_threshold = AUDX_DEFAULT_VAD_THRESHOLD;
+    config.stats_enabled = true;
+
+    int err;
+    NativeHandle *handle = audx_stream_create(&config, cfg.rate, cfg.quality, &err);
+    if (handle == nullptr) {
+        fprintf(stderr, "audx_stream_create(rate=%d, quality=%d) failed: %d\n",
+                cfg.rate, cfg.quality, err);
+        return err;
+    }
+
+    const int frame = handle->resampler_ctx->input_frame_samples;
+    std::vector<int16_t> speech = file_pcm.empty()
+            ? make_speech_like(cfg.rate, frame * kTrainSpeechFrames)
+            : file_pcm;
+    const int available = (int) (speech.size() / frame);
+    std::vector<int16_t> silence(frame, 0);
+    std::vector<int16_t> output(frame);
+    struct DenoiserResult result{};
+
+    int speech_pos = 0;
+    for (int cycle = 0; cycle < kTrainCycles; cycle++) {
+        for (int i = 0; i < kTrainSpeechFrames; i++, speech_pos++) {
+            const int16_t *in = speech.data() + (size_t) (speech_pos % available) * frame;
+            audx_stream_process(handle, in, output.data(), &result);
+        }
+        for (int i = 0; i < kTrainSilenceFrames; i++) {
+            audx_stream_process(handle, silence.data(), output.data(), &result);
+        }
+    }
+
+    struct DenoiserStats stats{};
+    get_denoiser_stats(handle->denoiser, &stats);
+    audx_stream_destroy(handle);
+
+    printf("trained rate=%d quality=%d frames=%d\n", cfg.rate, cfg.quality,
+           stats.frame_processed);
+    return AUDX_SUCCESS;
+}
+
+void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [--input FILE] [--rate HZ] [--quality Q] [--frames N] [--stages]\n"
+            "       %*s [--trace OUT.json] [--pipelined]\n"
+            "       %s --perf [--input FILE] [--rate HZ] [--quality Q] [--frames N]\n"
+            "       %s --interleave STREAMS [--input FILE] [--rate HZ] [--quality Q] [--frames N]\n"
+            "       %s --silence-decay [--input FILE] [--rate HZ] [--quality Q]\n"
+            "       %s --train [--input FILE]\n",
+            argv0, (int) strlen(argv0), "", argv0, argv0, argv0, argv0);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    BenchOptions opts;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--input") && i + 1 < argc) {
+            opts.input_path = argv[++i];
+        } else if (!strcmp(argv[i], "--rate") && i + 1 < argc) {
+            opts.rate = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--quality") && i + 1 < argc) {
+            opts.quality = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+            opts.frames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--train")) {
+            opts.train = true;
+        } else if (!strcmp(argv[i], "--stages")) {
+            opts.stages = true;
+        } else if (!strcmp(argv[i], "--perf")) {
+            opts.perf = true;
+        } else if (!strcmp(argv[i], "--interleave") && i + 1 < argc) {
+            opts.interleave = atoi(argv[++i]);
+            if (opts.interleave <= 0) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--pipelined")) {
+            opts.pipelined = true;
+        } else if (!strcmp(argv[i], "--silence-decay")) {
+            opts.silence_decay = true;
+        } else if (!strcmp(argv[i], "--trace") && i + 1 < argc) {
+            opts.trace_path = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (opts.frames <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<int16_t> file_pcm;
+    if (opts.input_path != nullptr && !load_pcm(opts.input_path, file_pcm)) {
+        fprintf(stderr, "Cannot read PCM input: %s\n", opts.input_path);
+        return 1;
+    }
+
+    if (opts.trace_path != nullptr) {
+#ifdef AUDX_TRACING
+        if (!audx_trace_open(opts.trace_path)) {
+            fprintf(stderr, "Cannot create trace file: %s\n", opts.trace_path);
+            return 1;
+        }
+        audx_trace_set_enabled(true);
+#else
+        fprintf(stderr, "--trace requires a build with AUDX_ENABLE_TRACING=ON\n");
+        return 2;
+#endif
+    }
+
+    if (opts.train) {
+        for (int rate : {48000, 16000, 8000}) {
+            for (int quality = AUDX_RESAMPLER_QUALITY_MIN;
+                 quality <= AUDX_RESAMPLER_QUALITY_MAX; quality++) {
+                if (rate == AUDX_DEFAULT_SAMPLE_RATE && quality > AUDX_RESAMPLER_QUALITY_MIN) {
+                    break;
+                }
+                if (train_config({rate, quality}, file_pcm) != AUDX_SUCCESS) {
+                    return 1;
+                }
+            }
+        }
+        return 0;
+    }
+
+    std::vector<int> rates = {48000, 16000, 8000};
+    std::vector<int> qualities = {AUDX_RESAMPLER_QUALITY_MIN,
+                                  AUDX_RESAMPLER_QUALITY_DEFAULT,
+                                  AUDX_RESAMPLER_QUALITY_MAX};
+    if (opts.rate > 0) {
+        rates = {opts.rate};
+    }
+    if (opts.quality >= 0) {
+        qualities = {opts.quality};
+    }
+
+    if (opts.silence_decay) {
+        printf("%6s %7s %8s %-8s %10s\n", "rate", "quality", "time_s", "phase", "mean_us");
+        int failures = 0;
+        for (int rate : rates) {
+            for (int quality : qualities) {
+                if (rate == AUDX_DEFAULT_SAMPLE_RATE && quality != qualities.front()) {
+                    continue;
+                }
+                int ret = decay_config({rate, quality}, file_pcm);
+                if (ret == AUDX_ERROR_EXTERNAL) {
+                    failures++;
+                } else if (ret != AUDX_SUCCESS) {
+                    return 1;
+                }
+            }
+        }
+        return failures > 0 ? 1 : 0;
+    }
+
+    if (opts.interleave > 0) {
+        printf("%6s %7s %7s %10s %10s %10s %10s\n", "rate", "quality", "streams",
+               "mean_us", "p99_us", "cache_miss", "dtlb_miss");
+        for (int rate : rates) {
+            for (int quality : qualities) {
+                if (rate == AUDX_DEFAULT_SAMPLE_RATE && quality != qualities.front()) {
+                    continue;
+                }
+                if (interleave_config({rate, quality}, opts, file_pcm) != AUDX_SUCCESS) {
+                    return 1;
+                }
+            }
+        }
+        return 0;
+    }
+
+    if (opts.perf) {
+#ifdef __linux__
+        printf("%6s %7s %-10s %12s %12s %6s %10s %10s\n", "rate", "quality", "stage",
+               "cycles", "instr", "ipc", "cache_miss", "br_miss");
+        for (int rate : rates) {
+            for (int quality : qualities) {
+                if (rate == AUDX_DEFAULT_SAMPLE_RATE && quality != qualities.front()) {
+                    continue;
+                }
+                if (perf_config({rate, quality}, opts, file_pcm) != AUDX_SUCCESS) {
+                    return 1;
+                }
+            }
+        }
+        return 0;
+#else
+        fprintf(stderr, "--perf requires Linux perf_event_open\n");
+        return 2;
+#endif
+    }
+
+    printf("%6s %7s %8s %10s %10s %10s %8s\n", "rate", "quality", "frames",
+           "mean_us", "p50_us", "p99_us", "rtf");
+    for (int rate : rates) {
+        for (int quality : qualities) {
+            // 48 kHz input never resamples; one row is enough
+            if (rate == AUDX_DEFAULT_SAMPLE_RATE && quality != qualities.front()) {
+                continue;
+            }
+            int ret = run_config({rate, quality}, opts, file_pcm);
+            if (ret != AUDX_SUCCESS) {
+                return 1;
+            }
+        }
+    }
+#ifdef AUDX_TRACING
+    audx_trace_close();
+#endif
+    return 0;
+}
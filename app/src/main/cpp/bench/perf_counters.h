@@ -0,0 +1,126 @@
+#ifndef AUDX_BENCH_PERF_COUNTERS_H
+#define AUDX_BENCH_PERF_COUNTERS_H
+
+#include <cstdint>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/** One reading of the counter group; fields are deltas once subtracted */
+struct PerfSample {
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t cache_misses;
+    uint64_t branch_misses;
+    uint64_t dtlb_misses;   // Data TLB load misses; 0 without has_dtlb()
+
+    PerfSample operator-(const PerfSample &o) const {
+        return {cycles - o.cycles, instructions - o.instructions,
+                cache_misses - o.cache_misses, branch_misses - o.branch_misses,
+                dtlb_misses - o.dtlb_misses};
+    }
+
+    PerfSample &operator+=(const PerfSample &o) {
+        cycles += o.cycles;
+        instructions += o.instructions;
+        cache_misses += o.cache_misses;
+        branch_misses += o.branch_misses;
+        dtlb_misses += o.dtlb_misses;
+        return *this;
+    }
+};
+
+/**
+ * Hardware counters for the calling thread via perf_event_open(2).
+ *
+ * The events are opened as one group so they are scheduled together and
+ * read with a single read(2). User-space only, so it works with the default
+ * perf_event_paranoid level of 2. The data TLB event is a generic cache event
+ * that not every PMU implements; without it the group has four events.
+ */
+class PerfCounters {
+public:
+    PerfCounters() {
+        const struct {
+            uint32_t type;
+            uint64_t config;
+        } events[kMaxEvents] = {
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+                {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                                     (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)}};
+        for (int i = 0; i < kMaxEvents; i++) {
+            fds_[i] = -1;
+        }
+        for (int i = 0; i < kMaxEvents; i++) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].type;
+            attr.config = events[i].config;
+            attr.disabled = i == 0;  // The leader starts the whole group
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            fds_[i] = (int) syscall(SYS_perf_event_open, &attr, 0, -1,
+                                    i == 0 ? -1 : fds_[0], 0);
+            if (fds_[i] < 0) {
+                if (i == kDtlbEvent) {
+                    break;
+                }
+                close_all();
+                return;
+            }
+            events_ = i + 1;
+        }
+        ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    ~PerfCounters() { close_all(); }
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    bool ok() const { return fds_[0] >= 0; }
+
+    bool has_dtlb() const { return events_ > kDtlbEvent; }
+
+    /**
+     * Read the whole group into *out. False on a failed or short read(2),
+     * leaving *out untouched; the caller must not subtract such a sample.
+     */
+    bool read_now(PerfSample *out) const {
+        uint64_t values[1 + kMaxEvents] = {};  // nr, then one value per event
+        const ssize_t bytes = (ssize_t) ((1 + events_) * sizeof(uint64_t));
+        if (fds_[0] < 0 || ::read(fds_[0], values, bytes) != bytes) {
+            return false;
+        }
+        *out = {values[1], values[2], values[3], values[4], values[5]};
+        return true;
+    }
+
+private:
+    static constexpr int kMaxEvents = 5;
+    static constexpr int kDtlbEvent = 4;   // Optional, last in the group
+
+    void close_all() {
+        for (int i = kMaxEvents - 1; i >= 0; i--) {
+            if (fds_[i] >= 0) {
+                close(fds_[i]);
+                fds_[i] = -1;
+            }
+        }
+        events_ = 0;
+    }
+
+    int fds_[kMaxEvents];
+    int events_ = 0;
+};
+
+#endif // AUDX_BENCH_PERF_COUNTERS_H
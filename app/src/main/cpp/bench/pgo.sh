@@ -0,0 +1,72 @@
+#!/usr/bin/env bash
+#
+# Profile-guided optimization flow for the host build of the audx pipeline.
+#
+#   1. plain build            -> baseline benchmark
+#   2. instrumented build     -> audx_bench --train writes profiles
+#   3. optimized build        -> benchmark with the profile applied
+#
+# and prints the per-configuration speedup of (3) over (1).
+#
+# Usage: bench/pgo.sh /path/to/audx-realtime [input.pcm]
+#
+# Build directories go to $BUILD_ROOT (default: ./build-pgo). Extra CMake
+# arguments (e.g. -DCMAKE_CXX_COMPILER=clang++) can be passed in $CMAKE_ARGS.
+
+set -euo pipefail
+
+if [ $# -lt 1 ]; then
+    echo "usage: $0 /path/to/audx-realtime [input.pcm]" >&2
+    exit 2
+fi
+
+CORE_DIR=$(realpath "$1")
+INPUT=${2:-}
+SRC_DIR=$(cd "$(dirname "$0")/.." && pwd)
+BUILD_ROOT=$(realpath -m "${BUILD_ROOT:-build-pgo}")
+PLAIN_DIR="$BUILD_ROOT/plain"
+PGO_DIR="$BUILD_ROOT/pgo"
+PROFILE_DIR="$BUILD_ROOT/profile"
+JOBS=$(nproc 2>/dev/null || echo 4)
+
+INPUT_ARGS=()
+if [ -n "$INPUT" ]; then
+    INPUT_ARGS=(--input "$(realpath "$INPUT")")
+fi
+
+configure() {
+    local dir=$1 pgo=$2
+    # shellcheck disable=SC2086
+    cmake -S "$SRC_DIR" -B "$dir" -DCMAKE_BUILD_TYPE=Release \
+        -DAUDX_CORE_SOURCE_DIR="$CORE_DIR" \
+        -DAUDX_PGO="$pgo" -DAUDX_PGO_DIR="$PROFILE_DIR" \
+        ${CMAKE_ARGS:-} > /dev/null
+}
+
+echo "== plain build"
+configure "$PLAIN_DIR" OFF
+cmake --build "$PLAIN_DIR" -j"$JOBS" > /dev/null
+"$PLAIN_DIR/audx_bench" "${INPUT_ARGS[@]}" | tee "$BUILD_ROOT/plain.txt"
+
+echo "== instrumented build + training"
+rm -rf "$PROFILE_DIR"
+configure "$PGO_DIR" GENERATE
+cmake --build "$PGO_DIR" -j"$JOBS" --clean-first > /dev/null
+"$PGO_DIR/audx_bench" --train "${INPUT_ARGS[@]}"
+
+if ls "$PROFILE_DIR"/*.profraw > /dev/null 2>&1; then
+    # Clang writes .profraw files that must be merged into audx.profdata
+    PROFDATA=${LLVM_PROFDATA:-llvm-profdata}
+    "$PROFDATA" merge -o "$PROFILE_DIR/audx.profdata" "$PROFILE_DIR"/*.profraw
+fi
+
+echo "== optimized build"
+# GCC locates .gcda files by object path, so rebuild in the same directory
+configure "$PGO_DIR" USE
+cmake --build "$PGO_DIR" -j"$JOBS" --clean-first > /dev/null
+"$PGO_DIR/audx_bench" "${INPUT_ARGS[@]}" | tee "$BUILD_ROOT/pgo.txt"
+
+echo "== speedup (plain mean / PGO mean)"
+paste "$BUILD_ROOT/plain.txt" "$BUILD_ROOT/pgo.txt" | awk '
+    NR == 1 { printf "%6s %7s %10s %10s %8s\n", "rate", "quality", "plain_us", "pgo_us", "speedup"; next }
+    { printf "%6d %7d %10.2f %10.2f %7.2fx\n", $1, $2, $4, $11, $4 / $11 }'
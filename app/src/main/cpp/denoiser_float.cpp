@@ -0,0 +1,79 @@
+#include "denoiser_float.h"
+
+#include <ctime>
+
+extern "C" {
+#include "audx/common.h"
+#include "audx/rnnoise.h"
+}
+
+namespace {
+
+/** Clock of the core's statistics: CLOCK_MONOTONIC in milliseconds */
+double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1000.0 + (double) ts.tv_nsec / 1e6;
+}
+
+/**
+ * Frame path behind the float entry points: conversion, RNNoise and a copy
+ * of the bookkeeping of the core's denoiser_process(), timed over the whole
+ * frame like the core does. input_pcm, when set, is converted into the
+ * processing buffer and replaces input.
+ */
+void process_frame(struct Denoiser *denoiser, const int16_t *input_pcm, const float *input,
+                   float *output, struct DenoiserResult *result) {
+    double start_ms = denoiser->stats_enabled ? now_ms() : 0.0;
+    if (input_pcm != nullptr) {
+        pcm_int16_to_float(input_pcm, denoiser->processing_buffer, AUDX_DEFAULT_FRAME_SIZE);
+        input = denoiser->processing_buffer;
+    }
+    float vad = rnnoise_process_frame(denoiser->denoiser_state, output, input);
+
+    if (denoiser->stats_enabled) {
+        double elapsed = now_ms() - start_ms;
+        denoiser->frames_processed++;
+        denoiser->total_vad_score += vad;
+        if (vad >= denoiser->vad_threshold) {
+            denoiser->speech_frames++;
+        }
+        if (vad < denoiser->min_vad_score) {
+            denoiser->min_vad_score = vad;
+        }
+        if (vad > denoiser->max_vad_score) {
+            denoiser->max_vad_score = vad;
+        }
+        // The core stores the frame time at float precision
+        denoiser->last_frame_time = (float) elapsed;
+        denoiser->total_processing_time += denoiser->last_frame_time;
+    }
+
+    if (result != nullptr) {
+        result->vad_probability = vad;
+        result->is_speech = vad >= denoiser->vad_threshold;
+        result->samples_processed = AUDX_DEFAULT_FRAME_SIZE;
+    }
+}
+
+}  // namespace
+
+int denoiser_process_float(struct Denoiser *denoiser, const int16_t *input_pcm,
+                           float *output, struct DenoiserResult *result) {
+    if (denoiser == nullptr || input_pcm == nullptr || output == nullptr) {
+        return AUDX_ERROR_INVALID;
+    }
+
+    process_frame(denoiser, input_pcm, nullptr, output, result);
+    return AUDX_SUCCESS;
+}
+
+int denoiser_process_float_frame(struct Denoiser *denoiser, const float *input,
+                                 float *output, struct DenoiserResult *result) {
+    if (denoiser == nullptr || input == nullptr || output == nullptr) {
+        return AUDX_ERROR_INVALID;
+    }
+
+    process_frame(denoiser, nullptr, input, output, result);
+    return AUDX_SUCCESS;
+}
@@ -0,0 +1,56 @@
+#ifndef AUDX_DENOISER_FLOAT_H
+#define AUDX_DENOISER_FLOAT_H
+
+#include <cstdint>
+
+extern "C" {
+#include "audx/denoiser.h"
+}
+
+/*
+ * The core has no float entry point, so these functions call
+ * rnnoise_process_frame() themselves and repeat the statistics and result
+ * bookkeeping of the core's denoiser_process() (as of the libaudx_src
+ * shipped in jniLibs) on the Denoiser fields. int16 frames keep going
+ * through the core. If a core update changes what denoiser_process()
+ * records, this copy must follow; testFloatPaths_MatchShortPathStatsAndVad
+ * compares the two paths' VAD and statistics and catches a divergence.
+ */
+
+/**
+ * @brief denoiser_process() with float output
+ *
+ * Same processing and statistics as denoiser_process(), but the RNNoise
+ * output is returned as is instead of being clamped and rounded to int16.
+ * Samples keep the int16 scale of the core's processing buffer (nominally
+ * -32768..32767) and may exceed it.
+ *
+ * @param denoiser    Denoiser instance
+ * @param input_pcm   One 48kHz frame (AUDX_DEFAULT_FRAME_SIZE samples)
+ * @param output      AUDX_DEFAULT_FRAME_SIZE samples; may be the denoiser's
+ *                    processing_buffer
+ * @param result      Optional per-frame result, as with denoiser_process()
+ *
+ * @return AUDX_SUCCESS, or AUDX_ERROR_INVALID for a NULL argument
+ */
+int denoiser_process_float(struct Denoiser *denoiser, const int16_t *input_pcm,
+                           float *output, struct DenoiserResult *result);
+
+/**
+ * @brief denoiser_process_float() for a frame that is already float
+ *
+ * Skips the int16 to float conversion. input uses the same int16 scale as
+ * the output.
+ *
+ * @param denoiser  Denoiser instance
+ * @param input     One 48kHz frame (AUDX_DEFAULT_FRAME_SIZE samples); may be
+ *                  the denoiser's processing_buffer and may equal output
+ * @param output    AUDX_DEFAULT_FRAME_SIZE samples
+ * @param result    Optional per-frame result, as with denoiser_process()
+ *
+ * @return AUDX_SUCCESS, or AUDX_ERROR_INVALID for a NULL argument
+ */
+int denoiser_process_float_frame(struct Denoiser *denoiser, const float *input,
+                                 float *output, struct DenoiserResult *result);
+
+#endif // AUDX_DENOISER_FLOAT_H
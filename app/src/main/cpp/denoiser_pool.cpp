@@ -0,0 +1,128 @@
+#include "denoiser_pool.h"
+
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "audx/logger.h"
+
+struct DenoiserPool {
+    std::mutex mutex;
+    void *slab = nullptr;                  // Arenas of all streams, back to back
+    std::vector<NativeHandle *> streams;   // Every stream, for teardown
+    std::vector<NativeHandle *> idle;      // Free stack, capacity reserved up front
+    int input_rate = 0;                    // Rate streams are returned to on release
+    int quality = 0;                       // Resampler quality, likewise
+    int in_use = 0;
+    bool closing = false;
+};
+
+namespace {
+
+void free_pool(DenoiserPool *pool) {
+    for (NativeHandle *handle : pool->streams) {
+        audx_stream_destroy(handle);
+    }
+    free(pool->slab);
+    delete pool;
+}
+
+}  // namespace
+
+DenoiserPool *audx_pool_create(const struct DenoiserConfig *config, int input_rate,
+                               int quality, int capacity, int *err) {
+    int ret;
+    if (err == nullptr) {
+        err = &ret;
+    }
+    if (capacity <= 0) {
+        *err = AUDX_ERROR_INVALID;
+        return nullptr;
+    }
+
+    auto *pool = new(std::nothrow) DenoiserPool();
+    if (pool == nullptr) {
+        *err = AUDX_ERROR_MEMORY;
+        return nullptr;
+    }
+
+    pool->input_rate = input_rate;
+    pool->quality = quality;
+    pool->streams.reserve(capacity);
+    pool->idle.reserve(capacity);
+
+    // One allocation for every stream's arena. Arena sizes are multiples of
+    // the alignment, so each one starts on its own cache line.
+    const size_t arena_size = audx_stream_arena_size(input_rate);
+    if (posix_memalign(&pool->slab, 64, arena_size * capacity) != 0) {
+        pool->slab = nullptr;
+        free_pool(pool);
+        *err = AUDX_ERROR_MEMORY;
+        return nullptr;
+    }
+    auto *slab = static_cast<char *>(pool->slab);
+
+    for (int i = 0; i < capacity; i++) {
+        NativeHandle *handle = audx_stream_create_in(slab + arena_size * i, config,
+                                                     input_rate, quality, err);
+        if (handle == nullptr) {
+            AUDX_LOGE("Failed to create pooled denoiser %d: %d", i, *err);
+            free_pool(pool);
+            return nullptr;
+        }
+
+        pool->streams.push_back(handle);
+        pool->idle.push_back(handle);
+    }
+
+    *err = AUDX_SUCCESS;
+    return pool;
+}
+
+NativeHandle *audx_pool_acquire(DenoiserPool *pool) {
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    if (pool->closing || pool->idle.empty()) {
+        return nullptr;
+    }
+    NativeHandle *handle = pool->idle.back();
+    pool->idle.pop_back();
+    pool->in_use++;
+    return handle;
+}
+
+void audx_pool_release(DenoiserPool *pool, NativeHandle *handle) {
+    // Outside the lock: only the releasing thread touches this stream
+    // Undo everything a user can change: restoring a state keeps the saved
+    // quality, and adaptive quality or stage timing stay on otherwise
+    audx_stream_reset(handle);
+    audx_stream_set_resample_quality(handle, pool->quality);
+    audx_stream_set_input_rate(handle, pool->input_rate);
+    audx_stream_set_band_features(handle, false);
+    audx_stream_set_band_gains(handle, false);
+    handle->stage_timers.set_enabled(false);
+    handle->stage_timers.reset();
+
+    bool last;
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->idle.push_back(handle);
+        pool->in_use--;
+        last = pool->closing && pool->in_use == 0;
+    }
+    if (last) {
+        free_pool(pool);
+    }
+}
+
+void audx_pool_destroy(DenoiserPool *pool) {
+    bool idle;
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->closing = true;
+        idle = pool->in_use == 0;
+    }
+    if (idle) {
+        free_pool(pool);
+    }
+}
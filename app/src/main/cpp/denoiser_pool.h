@@ -0,0 +1,56 @@
+#ifndef AUDX_DENOISER_POOL_H
+#define AUDX_DENOISER_POOL_H
+
+#include "stream.h"
+
+struct DenoiserPool;
+
+/**
+ * @brief Create a pool of ready-to-use streams with one configuration
+ *
+ * All streams are created up front in a single slab: their arenas (see
+ * audx_stream_create()) are laid out back to back in one 64-byte-aligned
+ * allocation, so the RNNoise states and scratch buffers of the whole pool
+ * are contiguous. Acquiring a stream later involves no allocation or model
+ * setup.
+ *
+ * @param config       Denoiser configuration (must not be NULL)
+ * @param input_rate   Input sample rate of every stream
+ * @param quality      Resampler quality (0-10)
+ * @param capacity     Number of streams
+ * @param err          Optional pointer to receive an AUDX_* error code
+ *
+ * @return New pool, or nullptr on failure
+ */
+DenoiserPool *audx_pool_create(const struct DenoiserConfig *config, int input_rate,
+                               int quality, int capacity, int *err);
+
+/**
+ * @brief Take an idle stream from the pool in O(1)
+ *
+ * Thread-safe. The stream behaves like a freshly created one.
+ *
+ * @return Stream handle, or nullptr if all streams are in use
+ */
+NativeHandle *audx_pool_acquire(DenoiserPool *pool);
+
+/**
+ * @brief Return a stream acquired from this pool
+ *
+ * Thread-safe. Resets the stream in place (audx_stream_reset()) on the
+ * calling thread and returns it to the pool's input rate and resampler
+ * quality, with adaptive quality, band features and gains and stage timing
+ * off, then makes it available again in O(1). The stream must not be used
+ * afterwards.
+ */
+void audx_pool_release(DenoiserPool *pool, NativeHandle *handle);
+
+/**
+ * @brief Destroy the pool
+ *
+ * Acquiring fails from now on. If streams are still in use they stay valid,
+ * and the pool and all its streams are freed when the last one is released.
+ */
+void audx_pool_destroy(DenoiserPool *pool);
+
+#endif // AUDX_DENOISER_POOL_H
@@ -0,0 +1,182 @@
+#include "denoiser_state.h"
+
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "audx/common.h"
+#include "audx/rnnoise.h"
+}
+
+namespace {
+
+// A literal run ends at the first run of this many unchanged bytes; shorter
+// gaps cost more as a new token than as literal bytes
+constexpr size_t kMinZeroRun = 4;
+constexpr size_t kMaxVarintBytes = 5;       // 32-bit lengths
+constexpr size_t kSectionHeaderBytes = 8;   // raw size, encoded size
+
+void put_u32(uint8_t *p, uint32_t v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+uint32_t get_u32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+size_t put_varint(uint8_t *p, size_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t) (v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t) v;
+    return n;
+}
+
+bool get_varint(const uint8_t *p, size_t size, size_t *pos, size_t *v) {
+    *v = 0;
+    for (size_t shift = 0; shift < 7 * kMaxVarintBytes; shift += 7) {
+        if (*pos >= size) {
+            return false;
+        }
+        uint8_t byte = p[(*pos)++];
+        *v |= (size_t) (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Fresh state for this denoiser's model; free() when done */
+DenoiseState *fresh_state(const struct Denoiser *denoiser) {
+    auto *fresh = (DenoiseState *) malloc(rnnoise_get_size());
+    if (fresh != nullptr) {
+        rnnoise_init(fresh, denoiser->model);
+    }
+    return fresh;
+}
+
+}  // namespace
+
+void denoiser_reset_stats(struct Denoiser *denoiser) {
+    denoiser->frames_processed = 0;
+    denoiser->speech_frames = 0;
+    denoiser->total_vad_score = 0.0f;
+    denoiser->min_vad_score = 1.0f;  // Reset to max so first frame sets new min
+    denoiser->max_vad_score = 0.0f;  // Reset to min so first frame sets new max
+    denoiser->total_processing_time = 0.0;
+    denoiser->last_frame_time = 0.0;
+}
+
+void denoiser_reset(struct Denoiser *denoiser) {
+    rnnoise_init(denoiser->denoiser_state, denoiser->model);
+    denoiser_reset_stats(denoiser);
+}
+
+size_t denoiser_state_size_bound(void) {
+    size_t n = rnnoise_get_size();
+    // Every token but the last is followed by at least kMinZeroRun bytes
+    size_t tokens = n / kMinZeroRun + 2;
+    return kSectionHeaderBytes + n + tokens * 2 * kMaxVarintBytes;
+}
+
+int denoiser_save_state(const struct Denoiser *denoiser, uint8_t *buf,
+                        size_t capacity, size_t *size) {
+    if (capacity < denoiser_state_size_bound()) {
+        return AUDX_ERROR_INVALID;
+    }
+
+    DenoiseState *fresh = fresh_state(denoiser);
+    if (fresh == nullptr) {
+        return AUDX_ERROR_MEMORY;
+    }
+
+    const size_t n = rnnoise_get_size();
+    const auto *state = (const uint8_t *) denoiser->denoiser_state;
+    const auto *base = (const uint8_t *) fresh;
+    uint8_t *out = buf + kSectionHeaderBytes;
+    size_t pos = 0;
+
+    size_t i = 0;
+    while (i < n) {
+        size_t zeros = 0;
+        while (i + zeros < n && state[i + zeros] == base[i + zeros]) {
+            zeros++;
+        }
+        i += zeros;
+
+        // Extend the literal run until kMinZeroRun unchanged bytes in a row
+        size_t end = i;
+        size_t unchanged = 0;
+        while (end < n && unchanged < kMinZeroRun) {
+            unchanged = state[end] == base[end] ? unchanged + 1 : 0;
+            end++;
+        }
+        if (unchanged == kMinZeroRun) {
+            end -= kMinZeroRun;
+        } else {
+            // Trailing unchanged bytes past the end are implied
+            end -= unchanged;
+        }
+
+        pos += put_varint(out + pos, zeros);
+        pos += put_varint(out + pos, end - i);
+        for (; i < end; i++) {
+            out[pos++] = state[i] ^ base[i];
+        }
+    }
+    free(fresh);
+
+    put_u32(buf, (uint32_t) n);
+    put_u32(buf + 4, (uint32_t) pos);
+    *size = kSectionHeaderBytes + pos;
+    return AUDX_SUCCESS;
+}
+
+int denoiser_restore_state(struct Denoiser *denoiser, const uint8_t *buf,
+                           size_t size, size_t *consumed) {
+    const size_t n = rnnoise_get_size();
+    if (size < kSectionHeaderBytes || get_u32(buf) != n) {
+        return AUDX_ERROR_INVALID;
+    }
+    size_t encoded = get_u32(buf + 4);
+    if (encoded > size - kSectionHeaderBytes) {
+        return AUDX_ERROR_INVALID;
+    }
+
+    // Decode onto a fresh state first so malformed data leaves the
+    // denoiser untouched
+    DenoiseState *restored = fresh_state(denoiser);
+    if (restored == nullptr) {
+        return AUDX_ERROR_MEMORY;
+    }
+
+    const uint8_t *in = buf + kSectionHeaderBytes;
+    auto *state = (uint8_t *) restored;
+    size_t pos = 0;
+    size_t i = 0;
+    while (pos < encoded) {
+        size_t zeros;
+        size_t literals;
+        if (!get_varint(in, encoded, &pos, &zeros) ||
+            !get_varint(in, encoded, &pos, &literals) ||
+            zeros > n - i || literals > n - i - zeros ||
+            literals > encoded - pos) {
+            free(restored);
+            return AUDX_ERROR_INVALID;
+        }
+        i += zeros;
+        for (size_t k = 0; k < literals; k++) {
+            state[i++] ^= in[pos++];
+        }
+    }
+
+    memcpy(denoiser->denoiser_state, restored, n);
+    free(restored);
+    *consumed = kSectionHeaderBytes + encoded;
+    return AUDX_SUCCESS;
+}
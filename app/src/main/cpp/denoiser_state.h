@@ -0,0 +1,69 @@
+#ifndef AUDX_DENOISER_STATE_H
+#define AUDX_DENOISER_STATE_H
+
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#include "audx/denoiser.h"
+}
+
+/**
+ * @brief Clear the statistics counters of a denoiser
+ */
+void denoiser_reset_stats(struct Denoiser *denoiser);
+
+/**
+ * @brief Return a denoiser to its just-created state without reallocating
+ *
+ * Re-initializes the existing DenoiseState with rnnoise_init() and clears the
+ * statistics counters; the model and buffers are kept.
+ *
+ * @param denoiser  Denoiser to reset; must not be processing concurrently
+ */
+void denoiser_reset(struct Denoiser *denoiser);
+
+/**
+ * @brief Upper bound on the size written by denoiser_save_state()
+ */
+size_t denoiser_state_size_bound(void);
+
+/**
+ * @brief Serialize the RNNoise state of a denoiser
+ *
+ * DenoiseState is opaque and holds pointers into the model, so it is stored
+ * as its XOR difference from a freshly initialized state with runs of zero
+ * bytes collapsed. The pointers cancel out, and restoring adds the
+ * difference back onto a fresh state of the destination denoiser.
+ *
+ * Only the model memory is saved (GRU states, noise estimates, analysis and
+ * synthesis buffers); statistics counters are not.
+ *
+ * @param denoiser  Denoiser to save; must not be processing concurrently
+ * @param buf       Output buffer
+ * @param capacity  Size of buf, at least denoiser_state_size_bound()
+ * @param size      Receives the number of bytes written
+ *
+ * @return AUDX_SUCCESS, or AUDX_ERROR_INVALID if buf is too small
+ */
+int denoiser_save_state(const struct Denoiser *denoiser, uint8_t *buf,
+                        size_t capacity, size_t *size);
+
+/**
+ * @brief Restore a state written by denoiser_save_state()
+ *
+ * The destination must use the same model as the source. The state is left
+ * untouched if the data is malformed.
+ *
+ * @param denoiser  Denoiser to restore into; must not be processing concurrently
+ * @param buf       Data written by denoiser_save_state()
+ * @param size      Size of buf
+ * @param consumed  Receives the number of bytes read from buf
+ *
+ * @return AUDX_SUCCESS, AUDX_ERROR_INVALID for malformed data, or
+ *         AUDX_ERROR_MEMORY
+ */
+int denoiser_restore_state(struct Denoiser *denoiser, const uint8_t *buf,
+                           size_t size, size_t *consumed);
+
+#endif // AUDX_DENOISER_STATE_H
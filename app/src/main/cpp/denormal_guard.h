@@ -0,0 +1,62 @@
+#ifndef AUDX_DENORMAL_GUARD_H
+#define AUDX_DENORMAL_GUARD_H
+
+#include <cstdint>
+
+/**
+ * Scoped flush-to-zero / denormals-are-zero.
+ *
+ * In long digital silence the RNNoise GRU state, the synthesis filter
+ * histories and the Speex resampler memories decay towards zero through the
+ * subnormal range, where every float operation takes a microcode assist and
+ * frame time can grow several-fold. Values that small are far below what
+ * survives conversion to int16, so flushing them to zero does not change the
+ * output.
+ *
+ * The guard sets FTZ|DAZ in MXCSR on x86 and FZ in FPCR on arm64 for its
+ * lifetime and restores the caller's mode on exit, so the JVM thread calling
+ * into the library never sees a changed floating-point environment.
+ *
+ * The compiler does not model the floating-point environment, so the mode
+ * switches are asm statements with a memory clobber: with LTO inlining the
+ * core into the stream layer, every result stored to state or output memory
+ * inside the scope is still computed between the two switches.
+ */
+class ScopedDenormalsOff {
+public:
+    ScopedDenormalsOff() {
+#if defined(__x86_64__) || defined(__i386__)
+        __asm__ __volatile__("stmxcsr %0" : "=m"(saved_) : : "memory");
+        unsigned int mxcsr = saved_ | kMxcsrFtz | kMxcsrDaz;
+        __asm__ __volatile__("ldmxcsr %0" : : "m"(mxcsr) : "memory");
+#elif defined(__aarch64__)
+        uint64_t fpcr;
+        __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr) : : "memory");
+        saved_ = fpcr;
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr | kFpcrFz) : "memory");
+#endif
+    }
+
+    ~ScopedDenormalsOff() {
+#if defined(__x86_64__) || defined(__i386__)
+        __asm__ __volatile__("ldmxcsr %0" : : "m"(saved_) : "memory");
+#elif defined(__aarch64__)
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(saved_) : "memory");
+#endif
+    }
+
+    ScopedDenormalsOff(const ScopedDenormalsOff &) = delete;
+    ScopedDenormalsOff &operator=(const ScopedDenormalsOff &) = delete;
+
+private:
+#if defined(__x86_64__) || defined(__i386__)
+    static constexpr unsigned int kMxcsrFtz = 0x8000;   // Flush results to zero
+    static constexpr unsigned int kMxcsrDaz = 0x0040;   // Treat subnormal inputs as zero
+    unsigned int saved_;
+#elif defined(__aarch64__)
+    static constexpr uint64_t kFpcrFz = 1ull << 24;     // Flush inputs and results to zero
+    uint64_t saved_;
+#endif
+};
+
+#endif // AUDX_DENORMAL_GUARD_H
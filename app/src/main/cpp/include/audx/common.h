@@ -3,6 +3,12 @@
 
 #include <stdint.h>
 
+#if defined(HAS_X86_SIMD)
+#include <smmintrin.h>
+#elif defined(HAS_ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #define PCM_SCALE_FLOAT_MAX 32767.0f
 #define PCM_SCALE_FLOAT_MIN -32768.0f
 
@@ -30,7 +36,7 @@ enum {
 /* --- Utility Converters --- */
 #ifdef HAS_X86_SIMD
 // SSE4.1-optimized int16 to float conversion
-inline void pcm_int16_to_float(const int16_t *input, float *output, int count) {
+static inline void pcm_int16_to_float(const int16_t *input, float *output, int count) {
   int i = 0;
   // Process 8 samples at a time using SSE4.1
   for (; i <= count - 8; i += 8) {
@@ -52,7 +58,7 @@ inline void pcm_int16_to_float(const int16_t *input, float *output, int count) {
 }
 
 // SSE2-optimized float to int16 conversion with clamping
-inline void pcm_float_to_int16(const float *input, int16_t *output, int count) {
+static inline void pcm_float_to_int16(const float *input, int16_t *output, int count) {
   int i = 0;
   const __m128 max_val = _mm_set1_ps(PCM_SCALE_FLOAT_MAX);
   const __m128 min_val = _mm_set1_ps(PCM_SCALE_FLOAT_MIN);
@@ -86,7 +92,7 @@ inline void pcm_float_to_int16(const float *input, int16_t *output, int count) {
 
 #elif defined(HAS_ARM_NEON)
 // ARM NEON-optimized int16 to float conversion
-inline void pcm_int16_to_float(const int16_t *input, float *output, int count) {
+static inline void pcm_int16_to_float(const int16_t *input, float *output, int count) {
   int i = 0;
   // Process 8 samples at a time using NEON
   for (; i <= count - 8; i += 8) {
@@ -107,7 +113,7 @@ inline void pcm_int16_to_float(const int16_t *input, float *output, int count) {
 }
 
 // ARM NEON-optimized float to int16 conversion with clamping
-inline void pcm_float_to_int16(const float *input, int16_t *output, int count) {
+static inline void pcm_float_to_int16(const float *input, int16_t *output, int count) {
   int i = 0;
   const float32x4_t max_val = vdupq_n_f32(PCM_SCALE_FLOAT_MAX);
   const float32x4_t min_val = vdupq_n_f32(PCM_SCALE_FLOAT_MIN);
@@ -143,7 +149,7 @@ inline void pcm_float_to_int16(const float *input, int16_t *output, int count) {
 
 #else
 // Scalar fallback for platforms without SIMD
-inline void pcm_int16_to_float(const int16_t *input, float *output, int count) {
+static inline void pcm_int16_to_float(const int16_t *input, float *output, int count) {
   for (int i = 0; i < count; i++)
     output[i] = (float)input[i];
 }
@@ -169,7 +175,7 @@ static inline void pcm_float_to_int16(const float *input, int16_t *output,
  * @param input_rate  Input sample rate in Hz.
  * @return Number of samples in a 10 ms frame.
  */
-inline audx_int32_t get_frame_samples(audx_int32_t input_rate) {
+static inline audx_int32_t get_frame_samples(audx_int32_t input_rate) {
   return input_rate * 10 / 1000;
 }
 
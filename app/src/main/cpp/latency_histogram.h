@@ -0,0 +1,139 @@
+#ifndef AUDX_LATENCY_HISTOGRAM_H
+#define AUDX_LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/** Monotonic clock used for all latency measurements, in nanoseconds */
+static inline uint64_t latency_clock_ns() {
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Percentile summary of a LatencyHistogram. Times are in milliseconds to
+ * match the ptime_* fields of DenoiserStats.
+ */
+struct LatencySummary {
+    uint32_t count;          // Frames recorded
+    float p50_ms;
+    float p95_ms;
+    float p99_ms;
+    float p999_ms;
+    float max_ms;            // Exact, not bucketed
+    uint32_t over_budget;    // Frames that took longer than the budget
+};
+
+/**
+ * Fixed-memory, log-bucketed latency histogram (HDR histogram layout).
+ *
+ * Values are nanoseconds. Each power of two is split into 2^kSubBucketBits
+ * linear sub-buckets, so every recorded value is kept with a relative error
+ * below 1/32 (~3%) from 1 ns up to ~4.3 s; larger values are clamped into the
+ * last bucket. record() is O(1): a count-leading-zeros, a shift and a relaxed
+ * counter increment.
+ *
+ * Single writer: record() and reset() must only be called from the audio
+ * thread. summarize() can be called from any thread; it reads the counters
+ * with relaxed loads, so a summary taken while frames are being recorded may
+ * miss the frame in flight but never reads torn counters.
+ */
+class LatencyHistogram {
+public:
+    static constexpr uint64_t kDefaultBudgetNs = 10000000;  // One 10 ms frame
+
+    explicit LatencyHistogram(uint64_t budget_ns = kDefaultBudgetNs)
+            : budget_ns_(budget_ns) {}
+
+    void record(uint64_t ns) {
+        bump(counts_[bucket_index(ns)]);
+        if (ns > max_ns_.load(std::memory_order_relaxed)) {
+            max_ns_.store(ns, std::memory_order_relaxed);
+        }
+        if (ns > budget_ns_) {
+            bump(over_budget_);
+        }
+    }
+
+    void reset() {
+        for (auto &count: counts_) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        max_ns_.store(0, std::memory_order_relaxed);
+        over_budget_.store(0, std::memory_order_relaxed);
+    }
+
+    LatencySummary summarize() const {
+        uint32_t counts[kBuckets];
+        uint64_t total = 0;
+        for (size_t i = 0; i < kBuckets; i++) {
+            counts[i] = counts_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+
+        LatencySummary summary{};
+        summary.count = (uint32_t) total;
+        summary.over_budget = over_budget_.load(std::memory_order_relaxed);
+        uint64_t max_ns = max_ns_.load(std::memory_order_relaxed);
+        summary.max_ms = to_ms(max_ns);
+        if (total == 0) {
+            return summary;
+        }
+
+        const double quantiles[] = {0.50, 0.95, 0.99, 0.999};
+        float *outputs[] = {&summary.p50_ms, &summary.p95_ms, &summary.p99_ms, &summary.p999_ms};
+        size_t q = 0;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets && q < 4; i++) {
+            seen += counts[i];
+            while (q < 4 && seen > 0 && (double) seen >= quantiles[q] * (double) total) {
+                uint64_t value = bucket_midpoint(i);
+                *outputs[q++] = to_ms(value < max_ns ? value : max_ns);
+            }
+        }
+        return summary;
+    }
+
+private:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kMaxValueBits = 32;
+    static constexpr uint64_t kSubBuckets = 1u << kSubBucketBits;
+    static constexpr size_t kBuckets = (size_t) (kMaxValueBits - kSubBucketBits + 1) << kSubBucketBits;
+
+    static size_t bucket_index(uint64_t ns) {
+        if (ns >= (1ull << kMaxValueBits)) {
+            ns = (1ull << kMaxValueBits) - 1;
+        }
+        if (ns < kSubBuckets) {
+            return (size_t) ns;
+        }
+        int shift = (63 - __builtin_clzll(ns)) - kSubBucketBits;
+        return ((size_t) (shift + 1) << kSubBucketBits) + (size_t) ((ns >> shift) & (kSubBuckets - 1));
+    }
+
+    static uint64_t bucket_midpoint(size_t index) {
+        size_t block = index >> kSubBucketBits;
+        uint64_t sub = index & (kSubBuckets - 1);
+        if (block == 0) {
+            return sub;
+        }
+        int shift = (int) block - 1;
+        return ((kSubBuckets + sub) << shift) + ((1ull << shift) >> 1);
+    }
+
+    static float to_ms(uint64_t ns) { return (float) ((double) ns / 1e6); }
+
+    // Single writer: a plain load/store avoids a locked read-modify-write
+    static void bump(std::atomic<uint32_t> &counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    uint64_t budget_ns_;
+    std::atomic<uint32_t> counts_[kBuckets]{};
+    std::atomic<uint64_t> max_ns_{0};
+    std::atomic<uint32_t> over_budget_{0};
+};
+
+#endif // AUDX_LATENCY_HISTOGRAM_H
@@ -1,39 +1,16 @@
 #include <jni.h>
 #include <string>
+#include <vector>
 #include <android/log.h>
 
-extern "C" {
-#include "audx/denoiser.h"
-#include "audx/common.h"
-#include "audx/resample.h"
-}
+#include "denoiser_pool.h"
+#include "stream.h"
+#include "trace.h"
 
 #define LOG_TAG "DenoiserJNI"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
-/**
- * Resampler context struct to hold resampling state
- */
-struct ResamplerContext {
-    int input_rate;
-    int output_rate;
-    int quality;
-    bool needs_resampling;
-    int input_frame_samples;
-    int output_frame_samples;
-    AudxResampler upsampler;      // Persistent upsampler (input_rate -> 48kHz)
-    AudxResampler downsampler;    // Persistent downsampler (48kHz -> input_rate)
-};
-
-/**
- * Combined native handle containing both denoiser and resampler context
- */
-struct NativeHandle {
-    Denoiser *denoiser;
-    ResamplerContext *resampler_ctx;
-};
-
 extern "C" JNIEXPORT jlong JNICALL
 Java_com_android_audx_AudxDenoiser_createNative(
         JNIEnv *env,
@@ -43,7 +20,8 @@ Java_com_android_audx_AudxDenoiser_createNative(
         jfloat vadThreshold,
         jboolean statsEnabled,
         jint inputSampleRate,
-        jint resampleQuality) {
+        jint resampleQuality,
+        jboolean pipelined) {
 
     struct DenoiserConfig config{};
     config.model_preset = static_cast<ModelPreset>(modelPreset);
@@ -56,63 +34,30 @@ Java_com_android_audx_AudxDenoiser_createNative(
     config.vad_threshold = vadThreshold;
     config.stats_enabled = statsEnabled;
 
-    auto *denoiser = new Denoiser();
-
-    int ret = denoiser_create(&config, denoiser);
-    if (ret != AUDX_SUCCESS) {
-        delete denoiser;
-        return 0;
-    }
+    int ret;
+    NativeHandle *handle = audx_stream_create(&config, inputSampleRate,
+                                              resampleQuality, &ret);
 
     if (model_path_str != nullptr) {
         env->ReleaseStringUTFChars(modelPath, model_path_str);
     }
 
-    if (ret < 0) {
+    if (handle == nullptr) {
         LOGE("Failed to create denoiser: %d", ret);
-        delete denoiser;
         return 0;
     }
 
-    // Create resampler context
-    auto *resampler_ctx = new ResamplerContext();
-    resampler_ctx->input_rate = inputSampleRate;
-    resampler_ctx->output_rate = AUDX_DEFAULT_SAMPLE_RATE;
-    resampler_ctx->quality = resampleQuality;
-    resampler_ctx->needs_resampling = (inputSampleRate != AUDX_DEFAULT_SAMPLE_RATE);
-    resampler_ctx->upsampler = nullptr;
-    resampler_ctx->downsampler = nullptr;
-
-    // Calculate frame sizes for 10ms chunks
-    resampler_ctx->input_frame_samples = get_frame_samples(inputSampleRate);
-    resampler_ctx->output_frame_samples = AUDX_DEFAULT_FRAME_SIZE;
-
-    // Create persistent resamplers if needed
-    if (resampler_ctx->needs_resampling) {
-        int err;
-        resampler_ctx->upsampler = audx_resample_create(
-                1, inputSampleRate, AUDX_DEFAULT_SAMPLE_RATE, resampleQuality, &err);
-        resampler_ctx->downsampler = audx_resample_create(
-                1, AUDX_DEFAULT_SAMPLE_RATE, inputSampleRate, resampleQuality, &err);
-
-        if (!resampler_ctx->upsampler || !resampler_ctx->downsampler) {
-            LOGE("Failed to create persistent resamplers");
-            audx_resample_destroy(resampler_ctx->upsampler);
-            audx_resample_destroy(resampler_ctx->downsampler);
-            delete resampler_ctx;
-            denoiser_destroy(denoiser);
-            delete denoiser;
+    if (pipelined) {
+        ret = audx_stream_start_pipeline(handle);
+        if (ret != AUDX_SUCCESS) {
+            LOGE("Failed to start pipelined mode: %d", ret);
+            audx_stream_destroy(handle);
             return 0;
         }
     }
 
     LOGI("Denoiser created with input_rate=%d, needs_resampling=%d, quality=%d",
-         inputSampleRate, resampler_ctx->needs_resampling, resampleQuality);
-
-    // Create combined handle
-    auto *handle = new NativeHandle();
-    handle->denoiser = denoiser;
-    handle->resampler_ctx = resampler_ctx;
+         inputSampleRate, handle->resampler_ctx->needs_resampling, resampleQuality);
 
     return reinterpret_cast<jlong>(handle);
 }
@@ -125,20 +70,70 @@ Java_com_android_audx_AudxDenoiser_destroyNative(
 
     auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
     if (native_handle != nullptr) {
-        if (native_handle->denoiser != nullptr) {
-            denoiser_destroy(native_handle->denoiser);
-            delete native_handle->denoiser;
-        }
+        audx_stream_destroy(native_handle);
+        LOGI("Denoiser and resampler destroyed");
+    }
+}
 
-        if (native_handle->resampler_ctx != nullptr) {
-            audx_resample_destroy(native_handle->resampler_ctx->upsampler);
-            audx_resample_destroy(native_handle->resampler_ctx->downsampler);
-            delete native_handle->resampler_ctx;
+/**
+ * DenoiserResult for one frame, or nullptr if the class cannot be found.
+ * With band features or gains on, they are copied into featuresArray and
+ * gainsArray (preallocated by AudxDenoiser, may be null) and the result
+ * refers to them.
+ */
+static jobject new_denoiser_result(JNIEnv *env, const NativeHandle *handle,
+                                   const struct DenoiserResult &result,
+                                   jfloatArray featuresArray, jfloatArray gainsArray) {
+    // Find Kotlin class
+    jclass resultClass = env->FindClass("com/android/audx/DenoiserResult");
+    if (resultClass == nullptr) {
+        LOGE("Cannot find DenoiserResult class");
+        return nullptr;
+    }
+
+    // Find constructor: (FZI[F[F)V — float, boolean, int, float[], float[]
+    jmethodID ctor = env->GetMethodID(resultClass, "<init>", "(FZI[F[F)V");
+    if (ctor == nullptr) {
+        LOGE("Cannot find DenoiserResult constructor");
+        return nullptr;
+    }
+
+    const BandFeatures *features = audx_stream_band_features(handle);
+    if (features != nullptr && featuresArray != nullptr) {
+        static_assert(sizeof(BandFeatures) == 2 * AUDX_NB_BANDS * sizeof(float),
+                      "BandFeatures is copied as one float array");
+        env->SetFloatArrayRegion(featuresArray, 0, 2 * AUDX_NB_BANDS,
+                                 reinterpret_cast<const jfloat *>(features));
+        if (env->ExceptionCheck()) {
+            return nullptr;
         }
+    } else {
+        featuresArray = nullptr;
+    }
 
-        delete native_handle;
-        LOGI("Denoiser and resampler destroyed");
+    const BandGains *gains = audx_stream_band_gains(handle);
+    if (gains != nullptr && gainsArray != nullptr) {
+        static_assert(sizeof(BandGains) == (AUDX_NB_BANDS + 2) * sizeof(float),
+                      "BandGains is copied as one float array");
+        env->SetFloatArrayRegion(gainsArray, 0, AUDX_NB_BANDS + 2,
+                                 reinterpret_cast<const jfloat *>(gains));
+        if (env->ExceptionCheck()) {
+            return nullptr;
+        }
+    } else {
+        gainsArray = nullptr;
     }
+
+    // Create and return Kotlin object
+    return env->NewObject(
+            resultClass,
+            ctor,
+            result.vad_probability,
+            result.is_speech,
+            result.samples_processed,
+            featuresArray,
+            gainsArray
+    );
 }
 
 extern "C" JNIEXPORT jobject JNICALL
@@ -147,127 +142,291 @@ Java_com_android_audx_AudxDenoiser_processNative(
         jobject /* this */,
         jlong handle,
         jshortArray inputArray,
-        jshortArray outputArray) {
+        jshortArray outputArray,
+        jfloatArray featuresArray,
+        jfloatArray gainsArray) {
 
+    AUDX_TRACE_SCOPE("audx:processNative");
     auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
     if (native_handle == nullptr || native_handle->denoiser == nullptr) {
         LOGE("Invalid native handle");
         return nullptr;
     }
 
-    Denoiser *denoiser = native_handle->denoiser;
-    ResamplerContext *resampler_ctx = native_handle->resampler_ctx;
+    // End-to-end time covers array access and result marshalling as well
+    bool timed = native_handle->denoiser->stats_enabled;
+    uint64_t start_ns = timed ? latency_clock_ns() : 0;
+    StageTimers &stage_timers = native_handle->stage_timers;
+    stage_timers.begin_frame();
 
     // Get array pointers
-    jshort *input = env->GetShortArrayElements(inputArray, nullptr);
-    jshort *output = env->GetShortArrayElements(outputArray, nullptr);
+    jshort *input;
+    jshort *output;
+    {
+        AUDX_TRACE_SCOPE("audx:pin_arrays");
+        input = env->GetShortArrayElements(inputArray, nullptr);
+        output = env->GetShortArrayElements(outputArray, nullptr);
+    }
+    stage_timers.lap(AUDX_STAGE_ARRAY_ACCESS);
 
-    int ret;
     struct DenoiserResult result{};
+    int ret = audx_stream_process(native_handle, input, output, &result);
+
+    if (ret != AUDX_SUCCESS) {
+        env->ReleaseShortArrayElements(inputArray, input, JNI_ABORT);
+        env->ReleaseShortArrayElements(outputArray, output, JNI_ABORT);
+        stage_timers.end_frame();
+        return nullptr;
+    }
 
-    if (resampler_ctx->needs_resampling) {
-        // Allocate temporary buffers for resampling
-        auto *resampled_input = (int16_t *) malloc(
-                resampler_ctx->output_frame_samples * sizeof(int16_t));
-        auto *resampled_output = (int16_t *) malloc(
-                resampler_ctx->output_frame_samples * sizeof(int16_t));
-
-        if (!resampled_input || !resampled_output) {
-            LOGE("Memory allocation failed for resample buffers");
-            free(resampled_input);
-            free(resampled_output);
-            env->ReleaseShortArrayElements(inputArray, input, JNI_ABORT);
-            env->ReleaseShortArrayElements(outputArray, output, JNI_ABORT);
+    // Release arrays
+    {
+        AUDX_TRACE_SCOPE("audx:release_arrays");
+        env->ReleaseShortArrayElements(inputArray, input, JNI_ABORT);
+        env->ReleaseShortArrayElements(outputArray, output, 0);
+    }
+    stage_timers.lap(AUDX_STAGE_ARRAY_ACCESS);
+
+    jobject resultObj;
+    {
+        AUDX_TRACE_SCOPE("audx:marshal");
+        resultObj = new_denoiser_result(env, native_handle, result, featuresArray, gainsArray);
+        if (resultObj == nullptr) {
+            stage_timers.end_frame();
             return nullptr;
         }
+    }
+    stage_timers.lap(AUDX_STAGE_MARSHAL);
+    stage_timers.end_frame();
 
-        // Resample input to 48kHz using persistent upsampler
-        audx_uint32_t in_len = resampler_ctx->input_frame_samples;
-        audx_uint32_t out_len = resampler_ctx->output_frame_samples;
-        ret = audx_resample_process(resampler_ctx->upsampler, (int16_t *) input,
-                                    &in_len, resampled_input, &out_len);
+    if (timed) {
+        native_handle->e2e_latency.record(latency_clock_ns() - start_ns);
+    }
 
-        if (ret != AUDX_SUCCESS) {
-            LOGE("Input resampling failed: %d", ret);
-            free(resampled_input);
-            free(resampled_output);
-            env->ReleaseShortArrayElements(inputArray, input, JNI_ABORT);
-            env->ReleaseShortArrayElements(outputArray, output, JNI_ABORT);
-            return nullptr;
-        }
+    return resultObj;
+}
 
-        // Denoise at 48kHz
-        ret = denoiser_process(denoiser, resampled_input, resampled_output, &result);
+/**
+ * Body of processFloatNative and processFloatInputNative: one frame with
+ * float output, from a ShortArray or (float_input) a FloatArray
+ */
+static jobject process_float_output(JNIEnv *env, jlong handle, jarray inputArray,
+                                    bool float_input, jfloatArray outputArray,
+                                    jfloatArray featuresArray,
+        jfloatArray gainsArray) {
+    auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
+    if (native_handle == nullptr || native_handle->denoiser == nullptr) {
+        LOGE("Invalid native handle");
+        return nullptr;
+    }
 
-        if (ret != AUDX_SUCCESS) {
-            LOGE("Denoiser processing failed: %d", ret);
-            free(resampled_input);
-            free(resampled_output);
-            env->ReleaseShortArrayElements(inputArray, input, JNI_ABORT);
-            env->ReleaseShortArrayElements(outputArray, output, JNI_ABORT);
+    bool timed = native_handle->denoiser->stats_enabled;
+    uint64_t start_ns = timed ? latency_clock_ns() : 0;
+    StageTimers &stage_timers = native_handle->stage_timers;
+    stage_timers.begin_frame();
+
+    void *input;
+    jfloat *output;
+    {
+        AUDX_TRACE_SCOPE("audx:pin_arrays");
+        input = float_input
+                ? (void *) env->GetFloatArrayElements((jfloatArray) inputArray, nullptr)
+                : (void *) env->GetShortArrayElements((jshortArray) inputArray, nullptr);
+        output = env->GetFloatArrayElements(outputArray, nullptr);
+    }
+    stage_timers.lap(AUDX_STAGE_ARRAY_ACCESS);
+
+    struct DenoiserResult result{};
+    int ret = float_input
+            ? audx_stream_process_float_input(native_handle, (const float *) input, output, &result)
+            : audx_stream_process_float(native_handle, (const int16_t *) input, output, &result);
+
+    {
+        AUDX_TRACE_SCOPE("audx:release_arrays");
+        if (float_input) {
+            env->ReleaseFloatArrayElements((jfloatArray) inputArray, (jfloat *) input, JNI_ABORT);
+        } else {
+            env->ReleaseShortArrayElements((jshortArray) inputArray, (jshort *) input, JNI_ABORT);
+        }
+        env->ReleaseFloatArrayElements(outputArray, output,
+                                       ret == AUDX_SUCCESS ? 0 : JNI_ABORT);
+    }
+    if (ret != AUDX_SUCCESS) {
+        LOGE("Float processing failed: %d", ret);
+        stage_timers.end_frame();
+        return nullptr;
+    }
+    stage_timers.lap(AUDX_STAGE_ARRAY_ACCESS);
+
+    jobject resultObj;
+    {
+        AUDX_TRACE_SCOPE("audx:marshal");
+        resultObj = new_denoiser_result(env, native_handle, result, featuresArray, gainsArray);
+        if (resultObj == nullptr) {
+            stage_timers.end_frame();
             return nullptr;
         }
+    }
+    stage_timers.lap(AUDX_STAGE_MARSHAL);
+    stage_timers.end_frame();
 
-        // Resample output back to original rate using persistent downsampler
-        in_len = resampler_ctx->output_frame_samples;
-        out_len = resampler_ctx->input_frame_samples;
-        ret = audx_resample_process(resampler_ctx->downsampler, resampled_output,
-                                    &in_len, (int16_t *) output, &out_len);
+    if (timed) {
+        native_handle->e2e_latency.record(latency_clock_ns() - start_ns);
+    }
 
-        free(resampled_input);
-        free(resampled_output);
+    return resultObj;
+}
 
-        if (ret != AUDX_SUCCESS) {
-            LOGE("Output resampling failed: %d", ret);
-            env->ReleaseShortArrayElements(inputArray, input, JNI_ABORT);
-            env->ReleaseShortArrayElements(outputArray, output, JNI_ABORT);
-            return nullptr;
-        }
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_android_audx_AudxDenoiser_processFloatNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jshortArray inputArray,
+        jfloatArray outputArray,
+        jfloatArray featuresArray,
+        jfloatArray gainsArray) {
 
-        // Update result to reflect actual output samples
-        result.samples_processed = (int) out_len;
-    } else {
-        // No resampling needed, process directly
-        ret = denoiser_process(denoiser, input, output, &result);
+    AUDX_TRACE_SCOPE("audx:processFloatNative");
+    return process_float_output(env, handle, inputArray, false, outputArray, featuresArray,
+                                gainsArray);
+}
 
-        if (ret != AUDX_SUCCESS) {
-            LOGE("Denoiser processing failed: %d", ret);
-            env->ReleaseShortArrayElements(inputArray, input, JNI_ABORT);
-            env->ReleaseShortArrayElements(outputArray, output, JNI_ABORT);
-            return nullptr;
-        }
-    }
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_android_audx_AudxDenoiser_processFloatInputNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jfloatArray inputArray,
+        jfloatArray outputArray,
+        jfloatArray featuresArray,
+        jfloatArray gainsArray) {
+
+    AUDX_TRACE_SCOPE("audx:processFloatInputNative");
+    return process_float_output(env, handle, inputArray, true, outputArray, featuresArray,
+                                gainsArray);
+}
 
-    // Release arrays
-    env->ReleaseShortArrayElements(inputArray, input, JNI_ABORT);
-    env->ReleaseShortArrayElements(outputArray, output, 0);
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_android_audx_AudxDenoiser_processPcmNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jint format,
+        jbyteArray inputArray,
+        jbyteArray outputArray,
+        jfloatArray featuresArray,
+        jfloatArray gainsArray) {
 
-    // Find Kotlin class
-    jclass resultClass = env->FindClass("com/android/audx/DenoiserResult");
-    if (resultClass == nullptr) {
-        LOGE("Cannot find DenoiserResult class");
+    AUDX_TRACE_SCOPE("audx:processPcmNative");
+    auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
+    if (native_handle == nullptr || native_handle->denoiser == nullptr) {
+        LOGE("Invalid native handle");
         return nullptr;
     }
 
-    // Find constructor: (FFI)V — 2 floats + int
-    jmethodID ctor = env->GetMethodID(resultClass, "<init>", "(FZI)V");
-    if (ctor == nullptr) {
-        LOGE("Cannot find DenoiserResult constructor");
+    bool timed = native_handle->denoiser->stats_enabled;
+    uint64_t start_ns = timed ? latency_clock_ns() : 0;
+    StageTimers &stage_timers = native_handle->stage_timers;
+    stage_timers.begin_frame();
+
+    jbyte *input;
+    jbyte *output;
+    {
+        AUDX_TRACE_SCOPE("audx:pin_arrays");
+        input = env->GetByteArrayElements(inputArray, nullptr);
+        output = env->GetByteArrayElements(outputArray, nullptr);
+    }
+    stage_timers.lap(AUDX_STAGE_ARRAY_ACCESS);
+
+    struct DenoiserResult result{};
+    int ret = audx_stream_process_pcm(native_handle, format, input, output, &result);
+
+    {
+        AUDX_TRACE_SCOPE("audx:release_arrays");
+        env->ReleaseByteArrayElements(inputArray, input, JNI_ABORT);
+        env->ReleaseByteArrayElements(outputArray, output, ret == AUDX_SUCCESS ? 0 : JNI_ABORT);
+    }
+    if (ret != AUDX_SUCCESS) {
+        LOGE("PCM processing failed: %d", ret);
+        stage_timers.end_frame();
         return nullptr;
     }
+    stage_timers.lap(AUDX_STAGE_ARRAY_ACCESS);
+
+    jobject resultObj;
+    {
+        AUDX_TRACE_SCOPE("audx:marshal");
+        resultObj = new_denoiser_result(env, native_handle, result, featuresArray, gainsArray);
+        if (resultObj == nullptr) {
+            stage_timers.end_frame();
+            return nullptr;
+        }
+    }
+    stage_timers.lap(AUDX_STAGE_MARSHAL);
+    stage_timers.end_frame();
 
-    // Create and return Kotlin object
-    jobject resultObj = env->NewObject(
-            resultClass,
-            ctor,
-            result.vad_probability,
-            result.is_speech,
-            result.samples_processed
-    );
+    if (timed) {
+        native_handle->e2e_latency.record(latency_clock_ns() - start_ns);
+    }
 
     return resultObj;
 }
 
+// Frames copied per JNI region transfer in processFramesNative
+static constexpr int kBatchFrames = 64;
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_android_audx_AudxDenoiser_processFramesNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jshortArray inputArray,
+        jint inputOffset,
+        jshortArray outputArray,
+        jint outputOffset,
+        jint frames) {
+
+    auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
+    if (native_handle == nullptr || native_handle->denoiser == nullptr) {
+        LOGE("Invalid native handle");
+        return AUDX_ERROR_INVALID;
+    }
+
+    AUDX_TRACE_SCOPE("audx:processFramesNative");
+    const int frame = native_handle->resampler_ctx->input_frame_samples;
+
+    // Copy through a small native buffer instead of pinning the whole array:
+    // offline inputs can be hours long and pinning would hold off the GC
+    std::vector<int16_t> in(static_cast<size_t>(frame) * kBatchFrames);
+    std::vector<int16_t> out(in.size());
+
+    for (int done = 0; done < frames; done += kBatchFrames) {
+        int batch = frames - done < kBatchFrames ? frames - done : kBatchFrames;
+        jsize samples = batch * frame;
+
+        env->GetShortArrayRegion(inputArray, inputOffset + done * frame, samples, in.data());
+        if (env->ExceptionCheck()) {
+            return AUDX_ERROR_INVALID;
+        }
+
+        for (int i = 0; i < batch; i++) {
+            int ret = audx_stream_process(native_handle, in.data() + i * frame,
+                                          out.data() + i * frame, nullptr);
+            if (ret != AUDX_SUCCESS) {
+                return ret;
+            }
+        }
+
+        env->SetShortArrayRegion(outputArray, outputOffset + done * frame, samples, out.data());
+        if (env->ExceptionCheck()) {
+            return AUDX_ERROR_INVALID;
+        }
+    }
+
+    return AUDX_SUCCESS;
+}
+
 // Expose native audio format constants to Kotlin
 extern "C" JNIEXPORT jint JNICALL
 Java_com_android_audx_AudxDenoiser_getSampleRateNative(
@@ -297,6 +456,33 @@ Java_com_android_audx_AudxDenoiser_getFrameSizeNative(
     return AUDX_DEFAULT_FRAME_SIZE;
 }
 
+// Build a Kotlin LatencyStats from a histogram summary
+static jobject new_latency_stats(JNIEnv *env, const LatencySummary &summary) {
+    jclass latencyClass = env->FindClass("com/android/audx/LatencyStats");
+    if (latencyClass == nullptr) {
+        LOGE("Cannot find LatencyStats class");
+        return nullptr;
+    }
+
+    // Find constructor: (FFFFFI)V — 5 floats + int
+    jmethodID ctor = env->GetMethodID(latencyClass, "<init>", "(FFFFFI)V");
+    if (ctor == nullptr) {
+        LOGE("Cannot find LatencyStats constructor");
+        return nullptr;
+    }
+
+    return env->NewObject(
+            latencyClass,
+            ctor,
+            summary.p50_ms,
+            summary.p95_ms,
+            summary.p99_ms,
+            summary.p999_ms,
+            summary.max_ms,
+            (jint) summary.over_budget
+    );
+}
+
 extern "C" JNIEXPORT jobject JNICALL
 Java_com_android_audx_AudxDenoiser_getStatsNative(
         JNIEnv *env,
@@ -309,11 +495,13 @@ Java_com_android_audx_AudxDenoiser_getStatsNative(
         return nullptr;
     }
 
-    struct DenoiserStats stats{};
-    int ret = get_denoiser_stats(native_handle->denoiser, &stats);
+    StreamStats stream_stats{};
+    audx_stream_get_stats(native_handle, &stream_stats);
+    const struct DenoiserStats &stats = stream_stats.denoiser;
 
-    if (ret != AUDX_SUCCESS) {
-        LOGE("Failed to get denoiser stats: %d", ret);
+    jobject processingLatency = new_latency_stats(env, stream_stats.denoise_latency);
+    jobject endToEndLatency = new_latency_stats(env, stream_stats.e2e_latency);
+    if (processingLatency == nullptr || endToEndLatency == nullptr) {
         return nullptr;
     }
 
@@ -324,8 +512,10 @@ Java_com_android_audx_AudxDenoiser_getStatsNative(
         return nullptr;
     }
 
-    // Find constructor: (IFFFFFFF)V — int + 7 floats
-    jmethodID ctor = env->GetMethodID(statsClass, "<init>", "(IFFFFFFF)V");
+    // Find constructor: int + 7 floats + 2 LatencyStats + int
+    jmethodID ctor = env->GetMethodID(
+            statsClass, "<init>",
+            "(IFFFFFFFLcom/android/audx/LatencyStats;Lcom/android/audx/LatencyStats;I)V");
     if (ctor == nullptr) {
         LOGE("Cannot find DenoiserStats constructor");
         return nullptr;
@@ -342,12 +532,107 @@ Java_com_android_audx_AudxDenoiser_getStatsNative(
             stats.vscores_max,
             stats.ptime_total,
             stats.ptime_avg,
-            stats.ptime_last
+            stats.ptime_last,
+            processingLatency,
+            endToEndLatency,
+            stream_stats.resample_quality
     );
 
     return statsObj;
 }
 
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_android_audx_AudxDenoiser_getStageTimingsNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle) {
+
+    auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
+    if (native_handle == nullptr || native_handle->denoiser == nullptr) {
+        LOGE("Invalid native handle");
+        return nullptr;
+    }
+
+    StageSummary stages[AUDX_STAGE_COUNT];
+    audx_stream_get_stage_timings(native_handle, stages);
+
+    jclass stageClass = env->FindClass("com/android/audx/StageTiming");
+    jclass timingsClass = env->FindClass("com/android/audx/StageTimings");
+    if (stageClass == nullptr || timingsClass == nullptr) {
+        LOGE("Cannot find StageTiming/StageTimings class");
+        return nullptr;
+    }
+
+    // Find constructors: StageTiming(IFFF)V — int + 3 floats,
+    // StageTimings — one StageTiming per stage
+    jmethodID stageCtor = env->GetMethodID(stageClass, "<init>", "(IFFF)V");
+    jmethodID timingsCtor = env->GetMethodID(
+            timingsClass, "<init>",
+            "(Lcom/android/audx/StageTiming;Lcom/android/audx/StageTiming;"
+            "Lcom/android/audx/StageTiming;Lcom/android/audx/StageTiming;"
+            "Lcom/android/audx/StageTiming;Lcom/android/audx/StageTiming;"
+            "Lcom/android/audx/StageTiming;)V");
+    if (stageCtor == nullptr || timingsCtor == nullptr) {
+        LOGE("Cannot find StageTiming/StageTimings constructor");
+        return nullptr;
+    }
+
+    jobject stageObjs[AUDX_STAGE_COUNT];
+    for (int i = 0; i < AUDX_STAGE_COUNT; i++) {
+        stageObjs[i] = env->NewObject(stageClass, stageCtor,
+                                      (jint) stages[i].frames,
+                                      stages[i].total_ms,
+                                      stages[i].avg_ms,
+                                      stages[i].max_ms);
+        if (stageObjs[i] == nullptr) {
+            return nullptr;
+        }
+    }
+
+    return env->NewObject(
+            timingsClass,
+            timingsCtor,
+            stageObjs[AUDX_STAGE_ARRAY_ACCESS],
+            stageObjs[AUDX_STAGE_UPSAMPLE],
+            stageObjs[AUDX_STAGE_DENOISE],
+            stageObjs[AUDX_STAGE_DOWNSAMPLE],
+            stageObjs[AUDX_STAGE_MARSHAL],
+            stageObjs[AUDX_STAGE_CONVERT],
+            stageObjs[AUDX_STAGE_ANALYSIS]
+    );
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_android_audx_AudxDenoiser_setStageTimingEnabledNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jboolean enabled) {
+
+    auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
+    if (native_handle == nullptr) {
+        LOGE("Invalid native handle");
+        return;
+    }
+
+    // Takes effect at the next frame
+    native_handle->stage_timers.set_enabled(enabled == JNI_TRUE);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_android_audx_AudxDenoiser_setTracingEnabledNative(
+        JNIEnv *env,
+        jclass /* clazz */,
+        jboolean enabled) {
+#ifdef AUDX_TRACING
+    audx_trace_set_enabled(enabled == JNI_TRUE);
+#else
+    if (enabled == JNI_TRUE) {
+        LOGI("Tracing requested but libaudx was built without AUDX_TRACING");
+    }
+#endif
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_android_audx_AudxDenoiser_resetStatsNative(
         JNIEnv *env,
@@ -360,22 +645,221 @@ Java_com_android_audx_AudxDenoiser_resetStatsNative(
         return;
     }
 
-    Denoiser *denoiser = native_handle->denoiser;
-
-    // Manually reset all statistics fields
-    denoiser->frames_processed = 0;
-    denoiser->speech_frames = 0;
-    denoiser->total_vad_score = 0.0f;
-    denoiser->min_vad_score = 1.0f;  // Reset to max so first frame sets new min
-    denoiser->max_vad_score = 0.0f;  // Reset to min so first frame sets new max
-    denoiser->total_processing_time = 0.0;
-    denoiser->last_frame_time = 0.0;
+    // Applied by the processing thread at the next frame boundary
+    audx_stream_reset_stats(native_handle);
 
     LOGI("Denoiser statistics reset");
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_android_audx_AudxDenoiser_resetNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle) {
+
+    auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
+    if (native_handle == nullptr || native_handle->denoiser == nullptr) {
+        LOGE("Invalid native handle");
+        return;
+    }
+
+    audx_stream_reset(native_handle);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_android_audx_AudxDenoiser_setAdaptiveQualityNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jint min_quality,
+        jint max_quality) {
+
+    auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
+    if (native_handle == nullptr || native_handle->denoiser == nullptr) {
+        LOGE("Invalid native handle");
+        return AUDX_ERROR_INVALID;
+    }
+
+    return audx_stream_set_adaptive_quality(native_handle, min_quality, max_quality);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_android_audx_AudxDenoiser_setBandFeaturesNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jboolean enabled) {
+
+    auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
+    if (native_handle == nullptr || native_handle->denoiser == nullptr) {
+        LOGE("Invalid native handle");
+        return AUDX_ERROR_INVALID;
+    }
+
+    return audx_stream_set_band_features(native_handle, enabled);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_android_audx_AudxDenoiser_setBandGainsNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jboolean enabled) {
+
+    auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
+    if (native_handle == nullptr || native_handle->denoiser == nullptr) {
+        LOGE("Invalid native handle");
+        return AUDX_ERROR_INVALID;
+    }
+
+    return audx_stream_set_band_gains(native_handle, enabled);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_android_audx_AudxDenoiser_setInputSampleRateNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jint input_rate) {
+
+    auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
+    if (native_handle == nullptr || native_handle->denoiser == nullptr) {
+        LOGE("Invalid native handle");
+        return AUDX_ERROR_INVALID;
+    }
+
+    int ret = audx_stream_set_input_rate(native_handle, input_rate);
+    if (ret != AUDX_SUCCESS) {
+        LOGE("Failed to change input rate to %d: %d", input_rate, ret);
+    } else {
+        LOGI("Input rate changed to %d", input_rate);
+    }
+    return ret;
+}
+
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_android_audx_AudxDenoiser_saveStateNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle) {
+
+    auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
+    if (native_handle == nullptr || native_handle->denoiser == nullptr) {
+        LOGE("Invalid native handle");
+        return nullptr;
+    }
+
+    std::vector<uint8_t> state(audx_stream_state_size_bound(native_handle));
+    size_t size;
+    int ret = audx_stream_save_state(native_handle, state.data(), state.size(), &size);
+    if (ret != AUDX_SUCCESS) {
+        LOGE("Failed to save state: %d", ret);
+        return nullptr;
+    }
+
+    jbyteArray result = env->NewByteArray((jsize) size);
+    if (result == nullptr) {
+        return nullptr;
+    }
+    env->SetByteArrayRegion(result, 0, (jsize) size, reinterpret_cast<const jbyte *>(state.data()));
+    return result;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_android_audx_AudxDenoiser_restoreStateNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jbyteArray state) {
+
+    auto *native_handle = reinterpret_cast<NativeHandle *>(handle);
+    if (native_handle == nullptr || native_handle->denoiser == nullptr) {
+        LOGE("Invalid native handle");
+        return AUDX_ERROR_INVALID;
+    }
+
+    jsize size = env->GetArrayLength(state);
+    std::vector<uint8_t> bytes(size);
+    env->GetByteArrayRegion(state, 0, size, reinterpret_cast<jbyte *>(bytes.data()));
+
+    int ret = audx_stream_restore_state(native_handle, bytes.data(), bytes.size());
+    if (ret != AUDX_SUCCESS) {
+        LOGE("Failed to restore state: %d", ret);
+    }
+    return ret;
+}
+
 extern "C" JNIEXPORT jint JNICALL
 Java_com_android_audx_AudxDenoiser_getFrameSamplesNative(JNIEnv *env, jobject thiz,
                                                          jint input_rate) {
     return get_frame_samples(input_rate);
-}
\ No newline at end of file
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_android_audx_AudxDenoiserPool_createPoolNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jint modelPreset,
+        jstring modelPath,
+        jfloat vadThreshold,
+        jboolean statsEnabled,
+        jint inputSampleRate,
+        jint resampleQuality,
+        jint size) {
+
+    struct DenoiserConfig config{};
+    config.model_preset = static_cast<ModelPreset>(modelPreset);
+
+    const char *model_path_str = nullptr;
+    if (modelPath != nullptr) {
+        model_path_str = env->GetStringUTFChars(modelPath, nullptr);
+    }
+    config.model_path = model_path_str;
+    config.vad_threshold = vadThreshold;
+    config.stats_enabled = statsEnabled;
+
+    int ret;
+    DenoiserPool *pool = audx_pool_create(&config, inputSampleRate, resampleQuality, size, &ret);
+
+    if (model_path_str != nullptr) {
+        env->ReleaseStringUTFChars(modelPath, model_path_str);
+    }
+
+    if (pool == nullptr) {
+        LOGE("Failed to create denoiser pool: %d", ret);
+        return 0;
+    }
+
+    LOGI("Denoiser pool created with %d instances, input_rate=%d", size, inputSampleRate);
+    return reinterpret_cast<jlong>(pool);
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_android_audx_AudxDenoiserPool_acquireNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong pool) {
+
+    return reinterpret_cast<jlong>(audx_pool_acquire(reinterpret_cast<DenoiserPool *>(pool)));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_android_audx_AudxDenoiserPool_releaseNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong pool,
+        jlong handle) {
+
+    audx_pool_release(reinterpret_cast<DenoiserPool *>(pool),
+                      reinterpret_cast<NativeHandle *>(handle));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_android_audx_AudxDenoiserPool_destroyPoolNative(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong pool) {
+
+    audx_pool_destroy(reinterpret_cast<DenoiserPool *>(pool));
+    LOGI("Denoiser pool destroyed");
+}
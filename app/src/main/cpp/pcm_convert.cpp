@@ -0,0 +1,330 @@
+#include "pcm_convert.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Full scale of each format; s24 samples are handled at s32 scale where the
+// kernels shift them into the top three bytes
+constexpr float kS24Scale = 8388608.0f;         // 2^23
+constexpr float kS32Scale = 2147483648.0f;      // 2^31
+constexpr float kS24Max = 8388607.0f;
+constexpr float kS32Max = 2147483520.0f;        // Largest float below 2^31
+
+int32_t float_to_s24_sample(float x) {
+    return (int32_t) lrintf(std::clamp(x * kS24Scale, -kS24Scale, kS24Max));
+}
+
+int32_t float_to_s32_sample(float x) {
+    return (int32_t) lrintf(std::clamp(x * kS32Scale, -kS32Scale, kS32Max));
+}
+
+int32_t s24_packed_sample(const uint8_t *p) {
+    // Sign-extend from the top byte
+    return (int32_t) ((uint32_t) p[0] << 8 | (uint32_t) p[1] << 16 | (uint32_t) p[2] << 24) >> 8;
+}
+
+void put_s24_packed_sample(uint8_t *p, int32_t v) {
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+    p[2] = (uint8_t) (v >> 16);
+}
+
+}  // namespace
+
+#if defined(HAS_X86_SIMD)
+#include <tmmintrin.h>
+
+// Defined in pcm_convert_avx2.cpp, which is built with -mavx2. Each handles
+// the leading multiple of its block size and returns the samples done.
+int pcm_s24_to_float_avx2(const uint8_t *input, float *output, int count);
+int pcm_float_to_s24_avx2(const float *input, uint8_t *output, int count);
+int pcm_s24_32_to_float_avx2(const int32_t *input, float *output, int count);
+int pcm_float_to_s24_32_avx2(const float *input, int32_t *output, int count);
+int pcm_s32_to_float_avx2(const int32_t *input, float *output, int count);
+int pcm_float_to_s32_avx2(const float *input, int32_t *output, int count);
+
+namespace {
+
+bool has_avx2() {
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+}  // namespace
+
+void pcm_s24_to_float(const uint8_t *input, float *output, int count) {
+    int i = has_avx2() ? pcm_s24_to_float_avx2(input, output, count) : 0;
+    // Bytes 3k..3k+2 of 12 into the top three bytes of lane k
+    const __m128i shuffle = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m128 scale = _mm_set1_ps(1.0f / kS32Scale);
+    // 16-byte loads read 4 bytes past the 12 they use: stop 2 samples early
+    for (; i <= count - 10; i += 8) {
+        __m128i lo = _mm_loadu_si128((const __m128i *) &input[3 * i]);
+        __m128i hi = _mm_loadu_si128((const __m128i *) &input[3 * i + 12]);
+        lo = _mm_shuffle_epi8(lo, shuffle);
+        hi = _mm_shuffle_epi8(hi, shuffle);
+        _mm_storeu_ps(&output[i], _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(&output[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    for (; i < count; i++)
+        output[i] = (float) s24_packed_sample(&input[3 * i]) / kS24Scale;
+}
+
+void pcm_float_to_s24(const float *input, uint8_t *output, int count) {
+    int i = has_avx2() ? pcm_float_to_s24_avx2(input, output, count) : 0;
+    // Low three bytes of each lane into the first 12 bytes
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    const __m128 scale = _mm_set1_ps(kS24Scale);
+    const __m128 max_val = _mm_set1_ps(kS24Max);
+    const __m128 min_val = _mm_set1_ps(-kS24Scale);
+    // Each 16-byte store writes 4 bytes past its 12; the next store (or the
+    // scalar tail) overwrites them, so stop 2 samples early
+    for (; i <= count - 10; i += 8) {
+        __m128 flo = _mm_mul_ps(_mm_loadu_ps(&input[i]), scale);
+        __m128 fhi = _mm_mul_ps(_mm_loadu_ps(&input[i + 4]), scale);
+        flo = _mm_min_ps(_mm_max_ps(flo, min_val), max_val);
+        fhi = _mm_min_ps(_mm_max_ps(fhi, min_val), max_val);
+        __m128i lo = _mm_shuffle_epi8(_mm_cvtps_epi32(flo), shuffle);
+        __m128i hi = _mm_shuffle_epi8(_mm_cvtps_epi32(fhi), shuffle);
+        _mm_storeu_si128((__m128i *) &output[3 * i], lo);
+        _mm_storeu_si128((__m128i *) &output[3 * i + 12], hi);
+    }
+    for (; i < count; i++)
+        put_s24_packed_sample(&output[3 * i], float_to_s24_sample(input[i]));
+}
+
+void pcm_s24_32_to_float(const int32_t *input, float *output, int count) {
+    int i = has_avx2() ? pcm_s24_32_to_float_avx2(input, output, count) : 0;
+    const __m128 scale = _mm_set1_ps(1.0f / kS32Scale);
+    for (; i <= count - 8; i += 8) {
+        // Shifting into the top bytes drops the ignored byte and sign-extends
+        __m128i lo = _mm_slli_epi32(_mm_loadu_si128((const __m128i *) &input[i]), 8);
+        __m128i hi = _mm_slli_epi32(_mm_loadu_si128((const __m128i *) &input[i + 4]), 8);
+        _mm_storeu_ps(&output[i], _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(&output[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    for (; i < count; i++)
+        output[i] = (float) (int32_t) ((uint32_t) input[i] << 8) / kS32Scale;
+}
+
+void pcm_float_to_s24_32(const float *input, int32_t *output, int count) {
+    int i = has_avx2() ? pcm_float_to_s24_32_avx2(input, output, count) : 0;
+    const __m128 scale = _mm_set1_ps(kS24Scale);
+    const __m128 max_val = _mm_set1_ps(kS24Max);
+    const __m128 min_val = _mm_set1_ps(-kS24Scale);
+    for (; i <= count - 8; i += 8) {
+        __m128 flo = _mm_mul_ps(_mm_loadu_ps(&input[i]), scale);
+        __m128 fhi = _mm_mul_ps(_mm_loadu_ps(&input[i + 4]), scale);
+        flo = _mm_min_ps(_mm_max_ps(flo, min_val), max_val);
+        fhi = _mm_min_ps(_mm_max_ps(fhi, min_val), max_val);
+        _mm_storeu_si128((__m128i *) &output[i], _mm_cvtps_epi32(flo));
+        _mm_storeu_si128((__m128i *) &output[i + 4], _mm_cvtps_epi32(fhi));
+    }
+    for (; i < count; i++)
+        output[i] = float_to_s24_sample(input[i]);
+}
+
+void pcm_s32_to_float(const int32_t *input, float *output, int count) {
+    int i = has_avx2() ? pcm_s32_to_float_avx2(input, output, count) : 0;
+    const __m128 scale = _mm_set1_ps(1.0f / kS32Scale);
+    for (; i <= count - 8; i += 8) {
+        __m128i lo = _mm_loadu_si128((const __m128i *) &input[i]);
+        __m128i hi = _mm_loadu_si128((const __m128i *) &input[i + 4]);
+        _mm_storeu_ps(&output[i], _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(&output[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    for (; i < count; i++)
+        output[i] = (float) input[i] / kS32Scale;
+}
+
+void pcm_float_to_s32(const float *input, int32_t *output, int count) {
+    int i = has_avx2() ? pcm_float_to_s32_avx2(input, output, count) : 0;
+    const __m128 scale = _mm_set1_ps(kS32Scale);
+    const __m128 max_val = _mm_set1_ps(kS32Max);
+    const __m128 min_val = _mm_set1_ps(-kS32Scale);
+    for (; i <= count - 8; i += 8) {
+        __m128 flo = _mm_mul_ps(_mm_loadu_ps(&input[i]), scale);
+        __m128 fhi = _mm_mul_ps(_mm_loadu_ps(&input[i + 4]), scale);
+        flo = _mm_min_ps(_mm_max_ps(flo, min_val), max_val);
+        fhi = _mm_min_ps(_mm_max_ps(fhi, min_val), max_val);
+        _mm_storeu_si128((__m128i *) &output[i], _mm_cvtps_epi32(flo));
+        _mm_storeu_si128((__m128i *) &output[i + 4], _mm_cvtps_epi32(fhi));
+    }
+    for (; i < count; i++)
+        output[i] = float_to_s32_sample(input[i]);
+}
+
+#elif defined(HAS_ARM_NEON)
+
+namespace {
+
+/** Widen 8 packed s24 samples, split into their three bytes, to int32 */
+void widen_s24(uint8x8x3_t bytes, int32x4_t *lo, int32x4_t *hi) {
+    uint16x8_t low16 = vorrq_u16(vmovl_u8(bytes.val[0]), vshlq_n_u16(vmovl_u8(bytes.val[1]), 8));
+    int16x8_t high16 = vmovl_s8(vreinterpret_s8_u8(bytes.val[2]));
+    *lo = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_low_s16(high16)), 16),
+                    vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low16))));
+    *hi = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_high_s16(high16)), 16),
+                    vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low16))));
+}
+
+/** Round and clamp 4 floats at the given scale */
+int32x4_t to_int32(float32x4_t x, float scale, float max) {
+    x = vminq_f32(vmaxq_f32(vmulq_n_f32(x, scale), vdupq_n_f32(-scale)), vdupq_n_f32(max));
+    return vcvtnq_s32_f32(x);
+}
+
+}  // namespace
+
+void pcm_s24_to_float(const uint8_t *input, float *output, int count) {
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        int32x4_t lo;
+        int32x4_t hi;
+        widen_s24(vld3_u8(&input[3 * i]), &lo, &hi);
+        vst1q_f32(&output[i], vmulq_n_f32(vcvtq_f32_s32(lo), 1.0f / kS24Scale));
+        vst1q_f32(&output[i + 4], vmulq_n_f32(vcvtq_f32_s32(hi), 1.0f / kS24Scale));
+    }
+    for (; i < count; i++)
+        output[i] = (float) s24_packed_sample(&input[3 * i]) / kS24Scale;
+}
+
+void pcm_float_to_s24(const float *input, uint8_t *output, int count) {
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        uint32x4_t lo = vreinterpretq_u32_s32(to_int32(vld1q_f32(&input[i]), kS24Scale, kS24Max));
+        uint32x4_t hi = vreinterpretq_u32_s32(to_int32(vld1q_f32(&input[i + 4]), kS24Scale, kS24Max));
+        uint16x8_t low16 = vcombine_u16(vmovn_u32(lo), vmovn_u32(hi));
+        uint16x8_t high16 = vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16));
+        uint8x8x3_t bytes;
+        bytes.val[0] = vmovn_u16(low16);
+        bytes.val[1] = vshrn_n_u16(low16, 8);
+        bytes.val[2] = vmovn_u16(high16);
+        vst3_u8(&output[3 * i], bytes);
+    }
+    for (; i < count; i++)
+        put_s24_packed_sample(&output[3 * i], float_to_s24_sample(input[i]));
+}
+
+void pcm_s24_32_to_float(const int32_t *input, float *output, int count) {
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        // Shifting into the top bytes drops the ignored byte and sign-extends
+        int32x4_t lo = vshlq_n_s32(vld1q_s32(&input[i]), 8);
+        int32x4_t hi = vshlq_n_s32(vld1q_s32(&input[i + 4]), 8);
+        vst1q_f32(&output[i], vmulq_n_f32(vcvtq_f32_s32(lo), 1.0f / kS32Scale));
+        vst1q_f32(&output[i + 4], vmulq_n_f32(vcvtq_f32_s32(hi), 1.0f / kS32Scale));
+    }
+    for (; i < count; i++)
+        output[i] = (float) (int32_t) ((uint32_t) input[i] << 8) / kS32Scale;
+}
+
+void pcm_float_to_s24_32(const float *input, int32_t *output, int count) {
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        vst1q_s32(&output[i], to_int32(vld1q_f32(&input[i]), kS24Scale, kS24Max));
+        vst1q_s32(&output[i + 4], to_int32(vld1q_f32(&input[i + 4]), kS24Scale, kS24Max));
+    }
+    for (; i < count; i++)
+        output[i] = float_to_s24_sample(input[i]);
+}
+
+void pcm_s32_to_float(const int32_t *input, float *output, int count) {
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        vst1q_f32(&output[i], vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(&input[i])), 1.0f / kS32Scale));
+        vst1q_f32(&output[i + 4],
+                  vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(&input[i + 4])), 1.0f / kS32Scale));
+    }
+    for (; i < count; i++)
+        output[i] = (float) input[i] / kS32Scale;
+}
+
+void pcm_float_to_s32(const float *input, int32_t *output, int count) {
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        vst1q_s32(&output[i], to_int32(vld1q_f32(&input[i]), kS32Scale, kS32Max));
+        vst1q_s32(&output[i + 4], to_int32(vld1q_f32(&input[i + 4]), kS32Scale, kS32Max));
+    }
+    for (; i < count; i++)
+        output[i] = float_to_s32_sample(input[i]);
+}
+
+#else
+// Scalar fallback for platforms without SIMD
+void pcm_s24_to_float(const uint8_t *input, float *output, int count) {
+    for (int i = 0; i < count; i++)
+        output[i] = (float) s24_packed_sample(&input[3 * i]) / kS24Scale;
+}
+
+void pcm_float_to_s24(const float *input, uint8_t *output, int count) {
+    for (int i = 0; i < count; i++)
+        put_s24_packed_sample(&output[3 * i], float_to_s24_sample(input[i]));
+}
+
+void pcm_s24_32_to_float(const int32_t *input, float *output, int count) {
+    for (int i = 0; i < count; i++)
+        output[i] = (float) (int32_t) ((uint32_t) input[i] << 8) / kS32Scale;
+}
+
+void pcm_float_to_s24_32(const float *input, int32_t *output, int count) {
+    for (int i = 0; i < count; i++)
+        output[i] = float_to_s24_sample(input[i]);
+}
+
+void pcm_s32_to_float(const int32_t *input, float *output, int count) {
+    for (int i = 0; i < count; i++)
+        output[i] = (float) input[i] / kS32Scale;
+}
+
+void pcm_float_to_s32(const float *input, int32_t *output, int count) {
+    for (int i = 0; i < count; i++)
+        output[i] = float_to_s32_sample(input[i]);
+}
+#endif
+
+int pcm_format_bytes(int format) {
+    switch (format) {
+        case AUDX_PCM_S24_PACKED:
+            return 3;
+        case AUDX_PCM_S24_IN_32:
+        case AUDX_PCM_S32:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+int pcm_format_to_float(int format, const void *input, float *output, int count) {
+    switch (format) {
+        case AUDX_PCM_S24_PACKED:
+            pcm_s24_to_float(static_cast<const uint8_t *>(input), output, count);
+            return AUDX_SUCCESS;
+        case AUDX_PCM_S24_IN_32:
+            pcm_s24_32_to_float(static_cast<const int32_t *>(input), output, count);
+            return AUDX_SUCCESS;
+        case AUDX_PCM_S32:
+            pcm_s32_to_float(static_cast<const int32_t *>(input), output, count);
+            return AUDX_SUCCESS;
+        default:
+            return AUDX_ERROR_INVALID;
+    }
+}
+
+int pcm_float_to_format(int format, const float *input, void *output, int count) {
+    switch (format) {
+        case AUDX_PCM_S24_PACKED:
+            pcm_float_to_s24(input, static_cast<uint8_t *>(output), count);
+            return AUDX_SUCCESS;
+        case AUDX_PCM_S24_IN_32:
+            pcm_float_to_s24_32(input, static_cast<int32_t *>(output), count);
+            return AUDX_SUCCESS;
+        case AUDX_PCM_S32:
+            pcm_float_to_s32(input, static_cast<int32_t *>(output), count);
+            return AUDX_SUCCESS;
+        default:
+            return AUDX_ERROR_INVALID;
+    }
+}
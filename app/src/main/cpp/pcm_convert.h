@@ -0,0 +1,60 @@
+#ifndef AUDX_PCM_CONVERT_H
+#define AUDX_PCM_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#include "audx/common.h"
+}
+
+/**
+ * 24- and 32-bit PCM converters, alongside pcm_int16_to_float() and
+ * pcm_float_to_int16() in audx/common.h
+ *
+ * Unlike the int16 pair, these convert to and from floats normalized to
+ * [-1, 1], the scale audx_stream_process_float_input() takes. Float to
+ * integer conversion rounds to nearest and clamps to the format's range.
+ * All formats are little-endian.
+ *
+ * Kernels: SSE4.1 or NEON per ABI (HAS_X86_SIMD/HAS_ARM_NEON), AVX2 on x86
+ * CPUs that support it (selected at run time), scalar otherwise.
+ */
+
+/** Integer PCM formats beyond int16 */
+enum AudxPcmFormat {
+    AUDX_PCM_S24_PACKED = 1,    // 3 bytes per sample (AudioFormat.ENCODING_PCM_24BIT_PACKED)
+    AUDX_PCM_S24_IN_32 = 2,     // Low 24 bits of an int32; the top byte is ignored on input
+                                // and the sign extension on output
+    AUDX_PCM_S32 = 3            // int32 (AudioFormat.ENCODING_PCM_32BIT)
+};
+
+void pcm_s24_to_float(const uint8_t *input, float *output, int count);
+void pcm_float_to_s24(const float *input, uint8_t *output, int count);
+
+void pcm_s24_32_to_float(const int32_t *input, float *output, int count);
+void pcm_float_to_s24_32(const float *input, int32_t *output, int count);
+
+void pcm_s32_to_float(const int32_t *input, float *output, int count);
+void pcm_float_to_s32(const float *input, int32_t *output, int count);
+
+/**
+ * @brief Bytes per sample of an AudxPcmFormat, or 0 for an unknown format
+ */
+int pcm_format_bytes(int format);
+
+/**
+ * @brief Convert count samples of an AudxPcmFormat to normalized floats
+ *
+ * @return AUDX_SUCCESS, or AUDX_ERROR_INVALID for an unknown format
+ */
+int pcm_format_to_float(int format, const void *input, float *output, int count);
+
+/**
+ * @brief Convert count normalized floats to an AudxPcmFormat
+ *
+ * @return AUDX_SUCCESS, or AUDX_ERROR_INVALID for an unknown format
+ */
+int pcm_float_to_format(int format, const float *input, void *output, int count);
+
+#endif // AUDX_PCM_CONVERT_H
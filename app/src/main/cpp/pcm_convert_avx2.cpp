@@ -0,0 +1,95 @@
+// AVX2 kernels for pcm_convert.cpp, built with -mavx2 and only called when
+// the CPU supports it. Each converts the leading multiple of 8 samples it can
+// handle safely and returns how many it did; the caller finishes the rest.
+
+#include <immintrin.h>
+
+#include <cstdint>
+
+namespace {
+
+constexpr float kS24Scale = 8388608.0f;         // 2^23
+constexpr float kS32Scale = 2147483648.0f;      // 2^31
+constexpr float kS24Max = 8388607.0f;
+constexpr float kS32Max = 2147483520.0f;        // Largest float below 2^31
+
+__m256i to_int32(__m256 x, float scale, float max) {
+    x = _mm256_mul_ps(x, _mm256_set1_ps(scale));
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-scale)), _mm256_set1_ps(max));
+    return _mm256_cvtps_epi32(x);
+}
+
+}  // namespace
+
+int pcm_s24_to_float_avx2(const uint8_t *input, float *output, int count) {
+    // Bytes 3k..3k+2 of each 12 into the top three bytes of lane k
+    const __m256i shuffle = _mm256_setr_epi8(
+            -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+            -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m256 scale = _mm256_set1_ps(1.0f / kS32Scale);
+    int i = 0;
+    // The upper 16-byte load reads 4 bytes past the 24 used: stop 2 samples early
+    for (; i <= count - 10; i += 8) {
+        __m128i lo = _mm_loadu_si128((const __m128i *) &input[3 * i]);
+        __m128i hi = _mm_loadu_si128((const __m128i *) &input[3 * i + 12]);
+        __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        v = _mm256_shuffle_epi8(v, shuffle);
+        _mm256_storeu_ps(&output[i], _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    return i;
+}
+
+int pcm_float_to_s24_avx2(const float *input, uint8_t *output, int count) {
+    // Low three bytes of each lane into the first 12 bytes of each half
+    const __m256i shuffle = _mm256_setr_epi8(
+            0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+            0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    int i = 0;
+    // Each 16-byte store writes 4 bytes past its 12, overwritten by the next
+    // store or the scalar tail: stop 2 samples early
+    for (; i <= count - 10; i += 8) {
+        __m256i v = _mm256_shuffle_epi8(to_int32(_mm256_loadu_ps(&input[i]), kS24Scale, kS24Max),
+                                        shuffle);
+        _mm_storeu_si128((__m128i *) &output[3 * i], _mm256_castsi256_si128(v));
+        _mm_storeu_si128((__m128i *) &output[3 * i + 12], _mm256_extracti128_si256(v, 1));
+    }
+    return i;
+}
+
+int pcm_s24_32_to_float_avx2(const int32_t *input, float *output, int count) {
+    const __m256 scale = _mm256_set1_ps(1.0f / kS32Scale);
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        __m256i v = _mm256_slli_epi32(_mm256_loadu_si256((const __m256i *) &input[i]), 8);
+        _mm256_storeu_ps(&output[i], _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    return i;
+}
+
+int pcm_float_to_s24_32_avx2(const float *input, int32_t *output, int count) {
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        _mm256_storeu_si256((__m256i *) &output[i],
+                            to_int32(_mm256_loadu_ps(&input[i]), kS24Scale, kS24Max));
+    }
+    return i;
+}
+
+int pcm_s32_to_float_avx2(const int32_t *input, float *output, int count) {
+    const __m256 scale = _mm256_set1_ps(1.0f / kS32Scale);
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) &input[i]);
+        _mm256_storeu_ps(&output[i], _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    return i;
+}
+
+int pcm_float_to_s32_avx2(const float *input, int32_t *output, int count) {
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        _mm256_storeu_si256((__m256i *) &output[i],
+                            to_int32(_mm256_loadu_ps(&input[i]), kS32Scale, kS32Max));
+    }
+    return i;
+}
@@ -0,0 +1,70 @@
+#ifndef AUDX_SEQLOCK_H
+#define AUDX_SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Single-writer sequence lock around a trivially copyable value.
+ *
+ * The writer (the audio thread) never blocks or retries: store() bumps the
+ * sequence to odd, copies the value and bumps it back to even. Readers on any
+ * thread copy the value and retry if the sequence was odd or changed while
+ * they were copying, so they never observe a torn value and never hold up
+ * the writer.
+ *
+ * The payload is kept in relaxed atomic words so concurrent copies are not
+ * data races.
+ */
+template<typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Seqlock payload must be trivially copyable");
+
+public:
+    Seqlock() = default;
+
+    explicit Seqlock(const T &value) { store(value); }
+
+    /** Publish a new value. Must only be called from the writer thread. */
+    void store(const T &value) {
+        uint64_t words[kWords] = {};
+        memcpy(words, &value, sizeof(T));
+
+        uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; i++) {
+            data_[i].store(words[i], std::memory_order_relaxed);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    /** Read a consistent copy of the latest value. Safe from any thread. */
+    T load() const {
+        uint64_t words[kWords];
+        uint32_t before, after;
+        do {
+            before = seq_.load(std::memory_order_acquire);
+            for (size_t i = 0; i < kWords; i++) {
+                words[i] = data_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = seq_.load(std::memory_order_relaxed);
+        } while ((before & 1u) != 0 || before != after);
+
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> seq_{0};
+    std::atomic<uint64_t> data_[kWords]{};
+};
+
+#endif // AUDX_SEQLOCK_H
@@ -0,0 +1,98 @@
+#ifndef AUDX_SPSC_QUEUE_H
+#define AUDX_SPSC_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <type_traits>
+
+/**
+ * Bounded single-producer single-consumer queue.
+ *
+ * push() and try_pop() are lock-free: one release store and one acquire load
+ * each, with head and tail on separate cache lines. A consumer that has to
+ * wait spins briefly and then sleeps on a condition variable; the producer
+ * only touches the mutex when the consumer is actually asleep, so the common
+ * path never takes a lock.
+ */
+template<typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "Queue items must be trivially copyable");
+
+public:
+    /** Producer only. Returns false if the queue is full. */
+    bool push(const T &item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        items_[tail & (Capacity - 1)] = item;
+        tail_.store(tail + 1, std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_one();
+        }
+        return true;
+    }
+
+    /** Consumer only. Returns false if the queue is empty. */
+    bool try_pop(T &item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items_[head & (Capacity - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Consumer only. Wait for an item; returns false without one if stop is
+     * set (see wake()).
+     */
+    bool pop_wait(T &item, const std::atomic<bool> &stop) {
+        for (int i = 0; i < kSpinIterations; i++) {
+            if (try_pop(item)) {
+                return true;
+            }
+            if (stop.load(std::memory_order_acquire)) {
+                return false;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleeping_.store(true, std::memory_order_seq_cst);
+        while (!try_pop(item)) {
+            if (stop.load(std::memory_order_acquire)) {
+                sleeping_.store(false, std::memory_order_relaxed);
+                return false;
+            }
+            cv_.wait(lock);
+        }
+        sleeping_.store(false, std::memory_order_relaxed);
+        return true;
+    }
+
+    /** Wake a sleeping consumer, e.g. after setting its stop flag */
+    void wake() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_one();
+    }
+
+private:
+    // Short enough not to burn a core while the other side is descheduled,
+    // long enough to cover a hand-off that is already in flight
+    static constexpr int kSpinIterations = 2000;
+
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) std::atomic<bool> sleeping_{false};
+    T items_[Capacity];
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+#endif // AUDX_SPSC_QUEUE_H
@@ -0,0 +1,134 @@
+#ifndef AUDX_STAGE_TIMERS_H
+#define AUDX_STAGE_TIMERS_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "latency_histogram.h"
+
+/**
+ * Stages of one frame through the JNI pipeline.
+ *
+ * RNN inference and synthesis both happen inside rnnoise_process_frame(), so
+ * they are reported together as AUDX_STAGE_DENOISE. Sample conversion done in
+ * this tree (float and 24/32-bit PCM frames) is AUDX_STAGE_CONVERT; for int16
+ * frames it happens inside the core's denoiser_process() and is part of
+ * AUDX_STAGE_DENOISE. The two newer stages come last so earlier indices keep
+ * their meaning.
+ */
+enum AudxStage {
+    AUDX_STAGE_ARRAY_ACCESS = 0,   // Get/Release*ArrayElements
+    AUDX_STAGE_UPSAMPLE,           // input rate -> 48kHz
+    AUDX_STAGE_DENOISE,            // Denoiser frame (and int16 conversion) and stats publishing
+    AUDX_STAGE_DOWNSAMPLE,         // 48kHz -> input rate
+    AUDX_STAGE_MARSHAL,            // DenoiserResult construction
+    AUDX_STAGE_CONVERT,            // In-tree sample conversion: float scaling, 24/32-bit PCM
+    AUDX_STAGE_ANALYSIS,           // Band features and gains, when enabled
+    AUDX_STAGE_COUNT
+};
+
+/** Aggregated time of one stage, in milliseconds */
+struct StageSummary {
+    uint32_t frames;     // Frames in which the stage ran
+    float total_ms;
+    float avg_ms;
+    float max_ms;
+};
+
+/**
+ * Per-stage timers for the processing pipeline.
+ *
+ * A frame is bracketed by begin_frame() / end_frame(); in between, each
+ * lap() charges the time since the previous lap (or begin_frame()) to the
+ * given stage, so consecutive stages share one clock read. When timing is
+ * disabled begin_frame() costs one relaxed load and every lap() is a single
+ * predictable branch.
+ *
+ * Single writer: begin_frame(), lap(), end_frame() and reset() must only be
+ * called from the processing thread. set_enabled() and summarize() can be
+ * called from any thread.
+ */
+class StageTimers {
+public:
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void begin_frame() {
+        if (!enabled_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        for (auto &ns: frame_ns_) {
+            ns = 0;
+        }
+        ran_ = 0;
+        last_ns_ = latency_clock_ns();
+    }
+
+    void lap(AudxStage stage) {
+        if (last_ns_ == 0) {
+            return;
+        }
+        uint64_t now = latency_clock_ns();
+        frame_ns_[stage] += now - last_ns_;
+        ran_ |= 1u << stage;
+        last_ns_ = now;
+    }
+
+    void end_frame() {
+        if (last_ns_ == 0) {
+            return;
+        }
+        for (int i = 0; i < AUDX_STAGE_COUNT; i++) {
+            if ((ran_ & (1u << i)) == 0) {
+                continue;
+            }
+            Stage &stage = stages_[i];
+            stage.frames.store(stage.frames.load(std::memory_order_relaxed) + 1,
+                               std::memory_order_relaxed);
+            stage.total_ns.store(stage.total_ns.load(std::memory_order_relaxed) + frame_ns_[i],
+                                 std::memory_order_relaxed);
+            if (frame_ns_[i] > stage.max_ns.load(std::memory_order_relaxed)) {
+                stage.max_ns.store(frame_ns_[i], std::memory_order_relaxed);
+            }
+        }
+        last_ns_ = 0;
+    }
+
+    void reset() {
+        for (auto &stage: stages_) {
+            stage.frames.store(0, std::memory_order_relaxed);
+            stage.total_ns.store(0, std::memory_order_relaxed);
+            stage.max_ns.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void summarize(StageSummary out[AUDX_STAGE_COUNT]) const {
+        for (int i = 0; i < AUDX_STAGE_COUNT; i++) {
+            const Stage &stage = stages_[i];
+            uint32_t frames = stage.frames.load(std::memory_order_relaxed);
+            double total_ms = (double) stage.total_ns.load(std::memory_order_relaxed) / 1e6;
+            out[i].frames = frames;
+            out[i].total_ms = (float) total_ms;
+            out[i].avg_ms = frames > 0 ? (float) (total_ms / frames) : 0.0f;
+            out[i].max_ms = (float) ((double) stage.max_ns.load(std::memory_order_relaxed) / 1e6);
+        }
+    }
+
+private:
+    struct Stage {
+        std::atomic<uint32_t> frames{0};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+    };
+
+    std::atomic<bool> enabled_{false};
+    Stage stages_[AUDX_STAGE_COUNT];
+
+    // Current frame, processing thread only
+    uint64_t last_ns_ = 0;
+    uint64_t frame_ns_[AUDX_STAGE_COUNT] = {};
+    uint32_t ran_ = 0;  // Bit per stage lapped this frame
+};
+
+#endif // AUDX_STAGE_TIMERS_H
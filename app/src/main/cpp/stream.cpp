@@ -0,0 +1,1326 @@
+#include "stream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+#include "audx/logger.h"
+#include "audx/rnnoise.h"
+#include "denoiser_float.h"
+#include "denoiser_state.h"
+#include "pcm_convert.h"
+#include "denormal_guard.h"
+#include "spsc_queue.h"
+#include "trace.h"
+
+/**
+ * Pipelined mode state. Two 48kHz frame slots alternate between the calling
+ * thread (which fills one with frame N and downsamples the other, frame N-1)
+ * and the inference thread; slot indices travel through the queues.
+ */
+struct StreamPipeline {
+    struct Slot {
+        int16_t input[AUDX_DEFAULT_FRAME_SIZE];
+        int16_t output[AUDX_DEFAULT_FRAME_SIZE];
+        struct DenoiserResult result;
+        int ret;
+    };
+
+    Slot slots[2];
+    uint32_t fill_slot = 0;     // Caller only: slot for the next input frame
+    bool in_flight = false;     // Caller only: a frame is with the inference thread
+
+    SpscQueue<uint32_t, 2> to_worker;
+    SpscQueue<uint32_t, 2> to_caller;
+    std::atomic<bool> stop{false};
+    std::thread worker;
+};
+
+namespace {
+
+// Longest Speex resampler filter (quality 10), in samples at the lower of
+// the two rates; the replayed history must cover it
+constexpr int kMaxResamplerTaps = 256;
+
+// Saved state blob: header words (magic, version, input rate, resampler
+// quality, upsampler and downsampler history frames), the float history
+// frames oldest first, then the denoiser_save_state() section. Native byte
+// order.
+constexpr uint32_t kStateMagic = 0x53445541;  // "AUDS"
+constexpr uint32_t kStateVersion = 3;
+constexpr int kStateHeaderWords = 6;
+constexpr int kStateHistoryWord = 4;          // First history frame count
+constexpr size_t kStateHeaderBytes = kStateHeaderWords * sizeof(uint32_t);
+
+// Arena blocks start on their own cache line
+constexpr size_t kCacheLineSize = 64;
+
+// Float input and output are normalized to [-1, 1]; the denoiser works at
+// int16 scale
+constexpr float kInt16ToFloat = 1.0f / 32768.0f;
+constexpr float kFloatToInt16 = 32768.0f;
+
+// Lowest rate audx_stream_set_input_rate() accepts (narrowband telephony)
+constexpr int kMinInputRate = 8000;
+
+// Adaptive resampler quality: real-time factor averaged over a one-second
+// window. A step up needs kStepUpWindows cheap windows in a row; the band
+// between the thresholds is the hysteresis.
+constexpr int kAdaptiveWindowFrames = 100;
+constexpr double kFrameBudgetNs = 10e6;
+constexpr double kStepDownRtf = 0.5;
+constexpr double kStepUpRtf = 0.25;
+constexpr int kStepUpWindows = 5;
+
+/**
+ * Frames of history covering the longest filter, for an input frame of
+ * input_frame samples
+ */
+int history_capacity(int input_frame) {
+    int lower_frame = std::min(input_frame, AUDX_DEFAULT_FRAME_SIZE);
+    return (kMaxResamplerTaps + lower_frame - 1) / lower_frame + 1;
+}
+
+/**
+ * Largest history rings, in samples, of any input rate from
+ * min(input_rate, kMinInputRate) to max_rate
+ */
+void history_bounds(int input_rate, int max_rate, size_t *upsampler, size_t *downsampler) {
+    *upsampler = 0;
+    *downsampler = 0;
+    int first = get_frame_samples(std::min(input_rate, kMinInputRate));
+    for (int frame = first; frame <= get_frame_samples(max_rate); frame++) {
+        size_t capacity = history_capacity(frame);
+        *upsampler = std::max(*upsampler, capacity * frame);
+        *downsampler = std::max(*downsampler, capacity * AUDX_DEFAULT_FRAME_SIZE);
+    }
+}
+
+void history_init(FrameHistory *history, float *frames, int frame_samples, int capacity) {
+    history->frames = frames;
+    history->frame_samples = frame_samples;
+    history->capacity = capacity;
+    history->next = 0;
+    history->count = 0;
+}
+
+/** Next slot of the ring, which becomes its newest frame */
+float *history_slot(FrameHistory *history) {
+    float *slot = history->frames + (size_t) history->next * history->frame_samples;
+    history->next = (history->next + 1) % history->capacity;
+    history->count = std::min(history->count + 1, history->capacity);
+    return slot;
+}
+
+/**
+ * Record an int16 frame. The float resampler holds int16 samples as the
+ * same float values, so replaying them as floats rebuilds the same memory.
+ */
+void history_push(FrameHistory *history, const int16_t *frame) {
+    float *slot = history_slot(history);
+    for (int i = 0; i < history->frame_samples; i++) {
+        slot[i] = frame[i];
+    }
+}
+
+/** Record a float frame, exactly as it was fed to the resampler */
+void history_push(FrameHistory *history, const float *frame) {
+    memcpy(history_slot(history), frame, history->frame_samples * sizeof(float));
+}
+
+/** Frame i of the valid frames, oldest first */
+const float *history_frame(const FrameHistory *history, int i) {
+    int slot = (history->next - history->count + i + history->capacity) % history->capacity;
+    return history->frames + (size_t) slot * history->frame_samples;
+}
+
+/** Feed frames through a resampler, discarding the output */
+int replay_history(AudxResampler resampler, const float *frames, int count,
+                   int in_samples, float *scratch, int out_samples) {
+    auto *state = static_cast<SpeexResamplerState *>(resampler);
+    for (int i = 0; i < count; i++) {
+        audx_uint32_t in_len = in_samples;
+        audx_uint32_t out_len = out_samples;
+        int ret = speex_resampler_process_float(state, 0, frames + (size_t) i * in_samples,
+                                                &in_len, scratch, &out_len);
+        if (ret != AUDX_SUCCESS) {
+            return ret;
+        }
+    }
+    return AUDX_SUCCESS;
+}
+
+/**
+ * Return a resampler to its just-created state: audx_resample_create()
+ * skips the filter's leading zeros, so the reset does too.
+ */
+void reset_resampler(AudxResampler resampler) {
+    auto *state = static_cast<SpeexResamplerState *>(resampler);
+    speex_resampler_reset_mem(state);
+    speex_resampler_skip_zeros(state);
+}
+
+void apply_pending_stats_reset(NativeHandle *handle) {
+    uint32_t requested = handle->stats_reset_requested.load(std::memory_order_acquire);
+    if (requested == handle->stats_reset_applied.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // Only called on the processing thread (or before the handle is shared),
+    // so it never races denoiser_process()
+    denoiser_reset_stats(handle->denoiser);
+    handle->denoise_latency.reset();
+    handle->e2e_latency.reset();
+    handle->stage_timers.reset();
+    handle->stats_snapshot.store(handle->initial_stats);
+    handle->stats_reset_applied.store(requested, std::memory_order_release);
+}
+
+void publish_stats(NativeHandle *handle) {
+    if (!handle->denoiser->stats_enabled) {
+        return;
+    }
+    struct DenoiserStats stats{};
+    get_denoiser_stats(handle->denoiser, &stats);
+    handle->stats_snapshot.store(stats);
+}
+
+/** denoiser_process() or denoiser_process_float_frame(), depending on the output type */
+int denoise_frame(Denoiser *denoiser, const int16_t *input, int16_t *output,
+                  struct DenoiserResult *result) {
+    return denoiser_process(denoiser, input, output, result);
+}
+
+int denoise_frame(Denoiser *denoiser, const float *input, float *output,
+                  struct DenoiserResult *result) {
+    return denoiser_process_float_frame(denoiser, input, output, result);
+}
+
+template<typename Input, typename Output>
+int timed_denoiser_process(NativeHandle *handle, const Input *input,
+                           Output *output, struct DenoiserResult *result) {
+    AUDX_TRACE_SCOPE("audx:denoise");
+    int ret;
+    if (!handle->denoiser->stats_enabled) {
+        ret = denoise_frame(handle->denoiser, input, output, result);
+    } else {
+        uint64_t start = latency_clock_ns();
+        ret = denoise_frame(handle->denoiser, input, output, result);
+        handle->denoise_latency.record(latency_clock_ns() - start);
+    }
+    if (result != nullptr) {
+        AUDX_TRACE_COUNTER("audx.vad_percent", result->vad_probability * 100.0f);
+    }
+    return ret;
+}
+
+/**
+ * Reader side of the reset protocol: statistics may be read only when no
+ * reset is pending, and the read is valid only if no reset was requested
+ * while it was in progress (stats_unchanged()).
+ */
+bool stats_readable(const NativeHandle *handle, uint32_t *requested) {
+    uint32_t applied = handle->stats_reset_applied.load(std::memory_order_acquire);
+    *requested = handle->stats_reset_requested.load(std::memory_order_acquire);
+    return *requested == applied;
+}
+
+bool stats_unchanged(const NativeHandle *handle, uint32_t requested) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return handle->stats_reset_requested.load(std::memory_order_relaxed) == requested;
+}
+
+void pipeline_worker(NativeHandle *handle) {
+#if defined(__linux__)
+    pthread_setname_np(pthread_self(), "audx-infer");
+#endif
+    // Held for the thread's lifetime; it only ever runs the denoiser
+    ScopedDenormalsOff denormals_off;
+    StreamPipeline *pipeline = handle->pipeline;
+
+    uint32_t index;
+    while (pipeline->to_worker.pop_wait(index, pipeline->stop)) {
+        StreamPipeline::Slot &slot = pipeline->slots[index];
+        slot.ret = timed_denoiser_process(handle, slot.input, slot.output, &slot.result);
+        if (slot.ret == AUDX_SUCCESS) {
+            publish_stats(handle);
+        }
+        pipeline->to_caller.push(index);
+    }
+}
+
+/**
+ * Calling-thread half of pipelined mode: upsample frame N, collect frame N-1
+ * from the inference thread, hand over frame N, downsample frame N-1.
+ */
+int pipelined_process(NativeHandle *handle, const int16_t *input,
+                      int16_t *output, struct DenoiserResult *result) {
+    StreamPipeline *pipeline = handle->pipeline;
+    ResamplerContext *resampler_ctx = handle->resampler_ctx;
+    StreamPipeline::Slot &fill = pipeline->slots[pipeline->fill_slot];
+    int ret;
+
+    if (resampler_ctx->needs_resampling) {
+        AUDX_TRACE_SCOPE("audx:upsample");
+        audx_uint32_t in_len = resampler_ctx->input_frame_samples;
+        audx_uint32_t out_len = resampler_ctx->output_frame_samples;
+        ret = audx_resample_process(resampler_ctx->upsampler, input,
+                                    &in_len, fill.input, &out_len);
+        if (ret != AUDX_SUCCESS) {
+            AUDX_LOGE("Input resampling failed: %d", ret);
+            return ret;
+        }
+        history_push(&resampler_ctx->upsampler_history, input);
+    } else {
+        memcpy(fill.input, input, sizeof(fill.input));
+    }
+    handle->stage_timers.lap(AUDX_STAGE_UPSAMPLE);
+
+    bool have_previous = pipeline->in_flight;
+    uint32_t done_index = 0;
+    if (have_previous) {
+        AUDX_TRACE_SCOPE("audx:wait_inference");
+        pipeline->to_caller.pop_wait(done_index, pipeline->stop);
+        handle->stage_timers.lap(AUDX_STAGE_DENOISE);
+    }
+
+    // The inference thread is idle until the push below, so the denoiser
+    // counters can be reset here without racing it
+    apply_pending_stats_reset(handle);
+
+    pipeline->to_worker.push(pipeline->fill_slot);
+    pipeline->in_flight = true;
+
+    if (!have_previous) {
+        // First frame: nothing has come out of the pipeline yet
+        pipeline->fill_slot ^= 1;
+        memset(output, 0, resampler_ctx->input_frame_samples * sizeof(int16_t));
+        if (result != nullptr) {
+            *result = DenoiserResult{};
+            result->samples_processed = resampler_ctx->input_frame_samples;
+        }
+        return AUDX_SUCCESS;
+    }
+
+    // The collected slot is downsampled now and refilled on the next call
+    pipeline->fill_slot = done_index;
+    StreamPipeline::Slot &done = pipeline->slots[done_index];
+    if (done.ret != AUDX_SUCCESS) {
+        AUDX_LOGE("Denoiser processing failed: %d", done.ret);
+        return done.ret;
+    }
+    if (result != nullptr) {
+        *result = done.result;
+    }
+
+    if (!resampler_ctx->needs_resampling) {
+        memcpy(output, done.output, sizeof(done.output));
+        return AUDX_SUCCESS;
+    }
+
+    audx_uint32_t in_len = resampler_ctx->output_frame_samples;
+    audx_uint32_t out_len = resampler_ctx->input_frame_samples;
+    {
+        AUDX_TRACE_SCOPE("audx:downsample");
+        ret = audx_resample_process(resampler_ctx->downsampler, done.output,
+                                    &in_len, output, &out_len);
+    }
+    if (ret != AUDX_SUCCESS) {
+        AUDX_LOGE("Output resampling failed: %d", ret);
+        return ret;
+    }
+    history_push(&resampler_ctx->downsampler_history, done.output);
+    handle->stage_timers.lap(AUDX_STAGE_DOWNSAMPLE);
+
+    if (result != nullptr) {
+        result->samples_processed = (int) out_len;
+    }
+    return AUDX_SUCCESS;
+}
+
+/**
+ * Byte offsets of the blocks of a stream's arena. Hot blocks come first, in
+ * the order a frame touches them; the Denoiser goes last among them so its
+ * 256-byte error_buffer tail runs into the cold blocks rather than sitting
+ * between two hot ones.
+ */
+struct ArenaLayout {
+    size_t handle;
+    size_t resampler_ctx;
+    size_t resampled_input;
+    size_t processing_buffer;
+    size_t resampled_output;
+    size_t denoise_state;
+    size_t denoiser;
+    size_t pcm_frame;             // Only used by audx_stream_process_pcm()
+    size_t features;              // Only used with band features or gains on
+    size_t upsampler_history;     // Cold: written once per frame, read on save
+    size_t downsampler_history;
+    size_t total;
+};
+
+size_t arena_reserve(size_t *offset, size_t bytes) {
+    size_t at = *offset;
+    *offset = (at + bytes + kCacheLineSize - 1) & ~(kCacheLineSize - 1);
+    return at;
+}
+
+ArenaLayout arena_layout(int input_rate, int max_input_rate) {
+    // Scratch and history are reserved even at 48kHz so the stream can
+    // switch rates later without reallocating
+    const size_t scratch = AUDX_DEFAULT_FRAME_SIZE * sizeof(int16_t);
+    size_t upsampler_history;
+    size_t downsampler_history;
+    history_bounds(input_rate, max_input_rate, &upsampler_history, &downsampler_history);
+
+    ArenaLayout layout{};
+    size_t offset = 0;
+    layout.handle = arena_reserve(&offset, sizeof(NativeHandle));
+    layout.resampler_ctx = arena_reserve(&offset, sizeof(ResamplerContext));
+    layout.resampled_input = arena_reserve(&offset, scratch);
+    layout.processing_buffer = arena_reserve(&offset, AUDX_DEFAULT_FRAME_SIZE * sizeof(float));
+    layout.resampled_output = arena_reserve(&offset, scratch);
+    // Sized by the core, not by a compile-time copy of its struct
+    layout.denoise_state = arena_reserve(&offset, rnnoise_get_size());
+    layout.denoiser = arena_reserve(&offset, sizeof(Denoiser));
+    layout.pcm_frame = arena_reserve(&offset, get_frame_samples(max_input_rate) * sizeof(float));
+    layout.features = arena_reserve(&offset, sizeof(FeatureContext));
+    layout.upsampler_history = arena_reserve(&offset, upsampler_history * sizeof(float));
+    layout.downsampler_history = arena_reserve(&offset, downsampler_history * sizeof(float));
+    layout.total = offset;
+    return layout;
+}
+
+/** Point the resampler context at input_rate; resamplers are left alone */
+void configure_input_rate(ResamplerContext *resampler_ctx, int input_rate) {
+    resampler_ctx->input_rate = input_rate;
+    resampler_ctx->needs_resampling = input_rate != AUDX_DEFAULT_SAMPLE_RATE;
+    resampler_ctx->input_frame_samples = get_frame_samples(input_rate);
+
+    const int capacity = history_capacity(resampler_ctx->input_frame_samples);
+    history_init(&resampler_ctx->upsampler_history, resampler_ctx->upsampler_history.frames,
+                 resampler_ctx->input_frame_samples, capacity);
+    history_init(&resampler_ctx->downsampler_history, resampler_ctx->downsampler_history.frames,
+                 resampler_ctx->output_frame_samples, capacity);
+}
+
+/**
+ * Move the RNNoise state and frame buffer denoiser_create() allocated into
+ * the arena. The core allocates them with rnnoise_create() and a one-frame
+ * calloc() and keeps no other pointer to them (see audx_stream_create());
+ * the sizes the arena was laid out with are checked against the core here.
+ */
+int adopt_denoiser_buffers(Denoiser *denoiser, DenoiseState *state, float *buffer) {
+    if (rnnoise_get_frame_size() != AUDX_DEFAULT_FRAME_SIZE ||
+        denoiser->denoiser_state == nullptr || denoiser->processing_buffer == nullptr) {
+        AUDX_LOGE("Unexpected core layout (frame size %d)", rnnoise_get_frame_size());
+        return AUDX_ERROR_UNSUPPORTED;
+    }
+    if (rnnoise_init(state, denoiser->model) != 0) {
+        return AUDX_ERROR_EXTERNAL;
+    }
+    rnnoise_destroy(denoiser->denoiser_state);
+    denoiser->denoiser_state = state;
+    free(denoiser->processing_buffer);
+    denoiser->processing_buffer = buffer;
+    return AUDX_SUCCESS;
+}
+
+/** denoiser_destroy() for a Denoiser whose state and buffer live in an arena */
+void destroy_arena_denoiser(Denoiser *denoiser) {
+    denoiser->denoiser_state = nullptr;
+    denoiser->processing_buffer = nullptr;
+    denoiser_destroy(denoiser);
+}
+
+/** Change the quality of both resamplers; false leaves it unchanged */
+bool set_resampler_quality(ResamplerContext *resampler_ctx, int quality) {
+    if (resampler_ctx->upsampler != nullptr) {
+        auto *upsampler = static_cast<SpeexResamplerState *>(resampler_ctx->upsampler);
+        auto *downsampler = static_cast<SpeexResamplerState *>(resampler_ctx->downsampler);
+        const int previous = resampler_ctx->quality;
+        if (speex_resampler_set_quality(upsampler, quality) != RESAMPLER_ERR_SUCCESS) {
+            return false;
+        }
+        if (speex_resampler_set_quality(downsampler, quality) != RESAMPLER_ERR_SUCCESS) {
+            speex_resampler_set_quality(upsampler, previous);
+            return false;
+        }
+    }
+    resampler_ctx->quality.store(quality, std::memory_order_relaxed);
+    return true;
+}
+
+/** Feed one frame time to the adaptive quality controller */
+void adapt_quality(ResamplerContext *resampler_ctx, uint64_t frame_ns) {
+    AdaptiveQuality &adaptive = resampler_ctx->adaptive;
+    if (!resampler_ctx->needs_resampling) {
+        return;
+    }
+    adaptive.window_ns += frame_ns;
+    if (++adaptive.window_frames < kAdaptiveWindowFrames) {
+        return;
+    }
+
+    const double rtf = (double) adaptive.window_ns / adaptive.window_frames / kFrameBudgetNs;
+    adaptive.window_ns = 0;
+    adaptive.window_frames = 0;
+
+    const int quality = resampler_ctx->quality;
+    int target = quality;
+    if (rtf > kStepDownRtf) {
+        adaptive.headroom_windows = 0;
+        target = std::max(quality - 1, adaptive.min_quality);
+    } else if (rtf < kStepUpRtf) {
+        if (++adaptive.headroom_windows >= kStepUpWindows) {
+            adaptive.headroom_windows = 0;
+            target = std::min(quality + 1, adaptive.max_quality);
+        }
+    } else {
+        adaptive.headroom_windows = 0;
+    }
+
+    if (target != quality) {
+        AUDX_TRACE_SCOPE("audx:set_quality");
+        if (set_resampler_quality(resampler_ctx, target)) {
+            AUDX_LOGI("Resampler quality %d -> %d (real-time factor %.2f)", quality, target, rtf);
+        }
+    }
+}
+
+/** Clear the output analysis window, shared by band features and gains */
+void reset_output_analysis(FeatureContext *features) {
+    band_analyzer_reset(&features->output_analyzer);
+    features->output = BandFeatures{};
+}
+
+/** Clear the state only band gains use: input window, delayed energies, noise floor */
+void reset_gain_analysis(FeatureContext *features) {
+    band_analyzer_reset(&features->input_analyzer);
+    features->gains = BandGains{};
+    std::fill_n(features->input_energy, AUDX_NB_BANDS, 0.0f);
+    std::fill_n(features->delayed_energy, AUDX_NB_BANDS, 0.0f);
+    features->noise_energy = -1.0f;
+}
+
+/** Clear the band analysis windows and the noise floor */
+void reset_band_analysis(FeatureContext *features) {
+    reset_output_analysis(features);
+    reset_gain_analysis(features);
+}
+
+/** Band energies of a 48kHz frame about to be denoised, when band gains are on */
+template<typename Sample>
+void analyze_input(NativeHandle *handle, const Sample *frame) {
+    FeatureContext *features = handle->features;
+    if (!features->gains_enabled) {
+        return;
+    }
+    {
+        AUDX_TRACE_SCOPE("audx:features");
+        band_analyze(&features->input_analyzer, frame, features->input_energy);
+    }
+    handle->stage_timers.lap(AUDX_STAGE_ANALYSIS);
+}
+
+/** Band features and gains of a denoised 48kHz frame, when enabled */
+template<typename Sample>
+void analyze_output(NativeHandle *handle, const Sample *frame) {
+    FeatureContext *features = handle->features;
+    if (!features->enabled && !features->gains_enabled) {
+        return;
+    }
+    {
+        AUDX_TRACE_SCOPE("audx:features");
+        band_analyze(&features->output_analyzer, frame, features->output.band_energy);
+        if (features->enabled) {
+            band_cepstrum(features->output.band_energy, features->output.cepstrum);
+        }
+        if (features->gains_enabled) {
+            // RNNoise's output lags its input by one frame
+            band_gains(features->delayed_energy, features->output.band_energy,
+                       &features->noise_energy, &features->gains);
+            memcpy(features->delayed_energy, features->input_energy,
+                   sizeof(features->input_energy));
+        }
+    }
+    handle->stage_timers.lap(AUDX_STAGE_ANALYSIS);
+}
+
+/** audx_stream_process() outside pipelined mode */
+int direct_process(NativeHandle *handle, const int16_t *input,
+                   int16_t *output, struct DenoiserResult *result) {
+    ResamplerContext *resampler_ctx = handle->resampler_ctx;
+    int ret;
+
+    apply_pending_stats_reset(handle);
+
+    if (!resampler_ctx->needs_resampling) {
+        // No resampling needed, process directly
+        analyze_input(handle, input);
+        ret = timed_denoiser_process(handle, input, output, result);
+        if (ret != AUDX_SUCCESS) {
+            AUDX_LOGE("Denoiser processing failed: %d", ret);
+            return ret;
+        }
+        publish_stats(handle);
+        handle->stage_timers.lap(AUDX_STAGE_DENOISE);
+        analyze_output(handle, output);
+        return AUDX_SUCCESS;
+    }
+
+    int16_t *resampled_input = resampler_ctx->resampled_input;
+    int16_t *resampled_output = resampler_ctx->resampled_output;
+
+    // Resample input to 48kHz using persistent upsampler
+    audx_uint32_t in_len = resampler_ctx->input_frame_samples;
+    audx_uint32_t out_len = resampler_ctx->output_frame_samples;
+    {
+        AUDX_TRACE_SCOPE("audx:upsample");
+        ret = audx_resample_process(resampler_ctx->upsampler, input,
+                                    &in_len, resampled_input, &out_len);
+    }
+
+    if (ret != AUDX_SUCCESS) {
+        AUDX_LOGE("Input resampling failed: %d", ret);
+        return ret;
+    }
+    history_push(&resampler_ctx->upsampler_history, input);
+    handle->stage_timers.lap(AUDX_STAGE_UPSAMPLE);
+
+    // Denoise at 48kHz
+    analyze_input(handle, resampled_input);
+    ret = timed_denoiser_process(handle, resampled_input, resampled_output, result);
+
+    if (ret != AUDX_SUCCESS) {
+        AUDX_LOGE("Denoiser processing failed: %d", ret);
+        return ret;
+    }
+
+    publish_stats(handle);
+    handle->stage_timers.lap(AUDX_STAGE_DENOISE);
+    analyze_output(handle, resampled_output);
+
+    // Resample output back to original rate using persistent downsampler
+    in_len = resampler_ctx->output_frame_samples;
+    out_len = resampler_ctx->input_frame_samples;
+    {
+        AUDX_TRACE_SCOPE("audx:downsample");
+        ret = audx_resample_process(resampler_ctx->downsampler, resampled_output,
+                                    &in_len, output, &out_len);
+    }
+
+    if (ret != AUDX_SUCCESS) {
+        AUDX_LOGE("Output resampling failed: %d", ret);
+        return ret;
+    }
+    history_push(&resampler_ctx->downsampler_history, resampled_output);
+    handle->stage_timers.lap(AUDX_STAGE_DOWNSAMPLE);
+
+    // Update result to reflect actual output samples
+    if (result != nullptr) {
+        result->samples_processed = (int) out_len;
+    }
+
+    return AUDX_SUCCESS;
+}
+
+/** 48kHz float frame at int16 scale from an int16 frame at the input rate */
+int load_frame(ResamplerContext *resampler_ctx, StageTimers &timers,
+               const int16_t *input, float *frame) {
+    const int16_t *pcm = input;
+    if (resampler_ctx->needs_resampling) {
+        audx_uint32_t in_len = resampler_ctx->input_frame_samples;
+        audx_uint32_t out_len = resampler_ctx->output_frame_samples;
+        int ret;
+        {
+            AUDX_TRACE_SCOPE("audx:upsample");
+            ret = audx_resample_process(resampler_ctx->upsampler, input,
+                                        &in_len, resampler_ctx->resampled_input, &out_len);
+        }
+        if (ret != AUDX_SUCCESS) {
+            return ret;
+        }
+        history_push(&resampler_ctx->upsampler_history, input);
+        pcm = resampler_ctx->resampled_input;
+        timers.lap(AUDX_STAGE_UPSAMPLE);
+    }
+    pcm_int16_to_float(pcm, frame, AUDX_DEFAULT_FRAME_SIZE);
+    timers.lap(AUDX_STAGE_CONVERT);
+    return AUDX_SUCCESS;
+}
+
+/** Same from a normalized float frame, without going through int16 */
+int load_frame(ResamplerContext *resampler_ctx, StageTimers &timers,
+               const float *input, float *frame) {
+    const float *src = input;
+    if (resampler_ctx->needs_resampling) {
+        audx_uint32_t in_len = resampler_ctx->input_frame_samples;
+        audx_uint32_t out_len = resampler_ctx->output_frame_samples;
+        int ret;
+        {
+            AUDX_TRACE_SCOPE("audx:upsample");
+            ret = speex_resampler_process_float(
+                    static_cast<SpeexResamplerState *>(resampler_ctx->upsampler), 0,
+                    input, &in_len, frame, &out_len);
+        }
+        if (ret != AUDX_SUCCESS) {
+            return ret;
+        }
+        history_push(&resampler_ctx->upsampler_history, input);
+        src = frame;
+        timers.lap(AUDX_STAGE_UPSAMPLE);
+    }
+    for (int i = 0; i < AUDX_DEFAULT_FRAME_SIZE; i++) {
+        frame[i] = src[i] * kFloatToInt16;
+    }
+    timers.lap(AUDX_STAGE_CONVERT);
+    return AUDX_SUCCESS;
+}
+
+/** audx_stream_process_float() and audx_stream_process_float_input() outside pipelined mode */
+template<typename Input>
+int direct_process_float(NativeHandle *handle, const Input *input,
+                         float *output, struct DenoiserResult *result) {
+    ResamplerContext *resampler_ctx = handle->resampler_ctx;
+    int ret;
+
+    apply_pending_stats_reset(handle);
+
+    // The 48kHz frame goes straight to the caller when no resampling is needed
+    float *frame = handle->denoiser->processing_buffer;
+    float *denoised = resampler_ctx->needs_resampling ? frame : output;
+
+    ret = load_frame(resampler_ctx, handle->stage_timers, input, frame);
+    if (ret != AUDX_SUCCESS) {
+        AUDX_LOGE("Input resampling failed: %d", ret);
+        return ret;
+    }
+
+    // Denoise at 48kHz, in place in the processing buffer
+    analyze_input(handle, frame);
+    ret = timed_denoiser_process(handle, frame, denoised, result);
+    if (ret != AUDX_SUCCESS) {
+        AUDX_LOGE("Denoiser processing failed: %d", ret);
+        return ret;
+    }
+    publish_stats(handle);
+    handle->stage_timers.lap(AUDX_STAGE_DENOISE);
+    analyze_output(handle, denoised);
+
+    int out_samples = AUDX_DEFAULT_FRAME_SIZE;
+    if (resampler_ctx->needs_resampling) {
+        audx_uint32_t in_len = resampler_ctx->output_frame_samples;
+        audx_uint32_t out_len = resampler_ctx->input_frame_samples;
+        {
+            AUDX_TRACE_SCOPE("audx:downsample");
+            ret = speex_resampler_process_float(
+                    static_cast<SpeexResamplerState *>(resampler_ctx->downsampler), 0,
+                    denoised, &in_len, output, &out_len);
+        }
+        if (ret != AUDX_SUCCESS) {
+            AUDX_LOGE("Output resampling failed: %d", ret);
+            return ret;
+        }
+        history_push(&resampler_ctx->downsampler_history, denoised);
+        handle->stage_timers.lap(AUDX_STAGE_DOWNSAMPLE);
+        out_samples = (int) out_len;
+        if (result != nullptr) {
+            result->samples_processed = out_samples;
+        }
+    }
+
+    // int16 scale to [-1, 1]
+    for (int i = 0; i < out_samples; i++) {
+        output[i] *= kInt16ToFloat;
+    }
+    handle->stage_timers.lap(AUDX_STAGE_CONVERT);
+    return AUDX_SUCCESS;
+}
+
+/**
+ * Per-frame wrapper shared by the int16 and float entry points: trace scope,
+ * denormals off, and adaptive resampler quality
+ */
+template<typename Process>
+int process_frame(NativeHandle *handle, Process process) {
+    AUDX_TRACE_SCOPE("audx:frame");
+    // Covers the resamplers and denoiser_process(); restored on return
+    ScopedDenormalsOff denormals_off;
+    ResamplerContext *resampler_ctx = handle->resampler_ctx;
+    const bool adaptive = resampler_ctx->adaptive.enabled;
+    const uint64_t start_ns = adaptive ? latency_clock_ns() : 0;
+
+    int ret = process();
+
+    if (adaptive && ret == AUDX_SUCCESS) {
+        adapt_quality(resampler_ctx, latency_clock_ns() - start_ns);
+    }
+    return ret;
+}
+
+}  // namespace
+
+size_t audx_stream_arena_size(int input_rate) {
+    const int max_input_rate = std::max(input_rate, AUDX_DEFAULT_SAMPLE_RATE);
+    return arena_layout(input_rate, max_input_rate).total;
+}
+
+NativeHandle *audx_stream_create(const struct DenoiserConfig *config,
+                                 int input_rate, int quality, int *err) {
+    int ret;
+    if (err == nullptr) {
+        err = &ret;
+    }
+
+    const size_t size = audx_stream_arena_size(input_rate);
+    void *arena = nullptr;
+    if (posix_memalign(&arena, kCacheLineSize, size) != 0) {
+        *err = AUDX_ERROR_MEMORY;
+        return nullptr;
+    }
+
+    NativeHandle *handle = audx_stream_create_in(arena, config, input_rate, quality, err);
+    if (handle == nullptr) {
+        free(arena);
+        return nullptr;
+    }
+    handle->owns_arena = true;
+    return handle;
+}
+
+NativeHandle *audx_stream_create_in(void *arena, const struct DenoiserConfig *config,
+                                    int input_rate, int quality, int *err) {
+    int ret;
+    if (err == nullptr) {
+        err = &ret;
+    }
+    if (arena == nullptr || reinterpret_cast<uintptr_t>(arena) % kCacheLineSize != 0) {
+        *err = AUDX_ERROR_INVALID;
+        return nullptr;
+    }
+
+    const int max_input_rate = std::max(input_rate, AUDX_DEFAULT_SAMPLE_RATE);
+    const ArenaLayout layout = arena_layout(input_rate, max_input_rate);
+
+    memset(arena, 0, layout.total);
+    auto *base = static_cast<char *>(arena);
+
+    auto *denoiser = new(base + layout.denoiser) Denoiser();
+
+    *err = denoiser_create(config, denoiser);
+    if (*err != AUDX_SUCCESS) {
+        AUDX_LOGE("Failed to create denoiser: %d", *err);
+        return nullptr;
+    }
+
+    // Move the state and frame buffer the core allocated into the arena
+    *err = adopt_denoiser_buffers(denoiser,
+                                  reinterpret_cast<DenoiseState *>(base + layout.denoise_state),
+                                  reinterpret_cast<float *>(base + layout.processing_buffer));
+    if (*err != AUDX_SUCCESS) {
+        denoiser_destroy(denoiser);
+        return nullptr;
+    }
+
+    // Create resampler context. Scratch frames live in the arena so the
+    // per-frame path never touches the heap.
+    auto *resampler_ctx = new(base + layout.resampler_ctx) ResamplerContext();
+    resampler_ctx->max_input_rate = max_input_rate;
+    resampler_ctx->output_rate = AUDX_DEFAULT_SAMPLE_RATE;
+    resampler_ctx->quality = quality;
+    resampler_ctx->upsampler = nullptr;
+    resampler_ctx->downsampler = nullptr;
+    resampler_ctx->output_frame_samples = AUDX_DEFAULT_FRAME_SIZE;
+    resampler_ctx->resampled_input = reinterpret_cast<int16_t *>(base + layout.resampled_input);
+    resampler_ctx->resampled_output = reinterpret_cast<int16_t *>(base + layout.resampled_output);
+    resampler_ctx->pcm_frame = reinterpret_cast<float *>(base + layout.pcm_frame);
+    resampler_ctx->upsampler_history.frames =
+            reinterpret_cast<float *>(base + layout.upsampler_history);
+    resampler_ctx->downsampler_history.frames =
+            reinterpret_cast<float *>(base + layout.downsampler_history);
+    configure_input_rate(resampler_ctx, input_rate);
+
+    // Create persistent resamplers if needed
+    if (resampler_ctx->needs_resampling) {
+        resampler_ctx->upsampler = audx_resample_create(
+                1, input_rate, AUDX_DEFAULT_SAMPLE_RATE, quality, err);
+        resampler_ctx->downsampler = audx_resample_create(
+                1, AUDX_DEFAULT_SAMPLE_RATE, input_rate, quality, err);
+
+        if (!resampler_ctx->upsampler || !resampler_ctx->downsampler) {
+            AUDX_LOGE("Failed to create persistent resamplers");
+            audx_resample_destroy(resampler_ctx->upsampler);
+            audx_resample_destroy(resampler_ctx->downsampler);
+            destroy_arena_denoiser(denoiser);
+            *err = AUDX_ERROR_MEMORY;
+            return nullptr;
+        }
+    }
+
+    auto *handle = new(base + layout.handle) NativeHandle();
+    handle->denoiser = denoiser;
+    handle->resampler_ctx = resampler_ctx;
+    handle->pipeline = nullptr;
+    handle->features = new(base + layout.features) FeatureContext();
+    handle->owns_arena = false;
+
+    denoiser_reset_stats(denoiser);
+    get_denoiser_stats(denoiser, &handle->initial_stats);
+    handle->stats_snapshot.store(handle->initial_stats);
+
+    *err = AUDX_SUCCESS;
+    return handle;
+}
+
+int audx_stream_process(NativeHandle *handle, const int16_t *input,
+                        int16_t *output, struct DenoiserResult *result) {
+    return process_frame(handle, [&] {
+        return handle->pipeline != nullptr
+                ? pipelined_process(handle, input, output, result)
+                : direct_process(handle, input, output, result);
+    });
+}
+
+int audx_stream_process_float(NativeHandle *handle, const int16_t *input,
+                              float *output, struct DenoiserResult *result) {
+    if (handle->pipeline != nullptr) {
+        return AUDX_ERROR_UNSUPPORTED;
+    }
+    return process_frame(handle, [&] {
+        return direct_process_float(handle, input, output, result);
+    });
+}
+
+int audx_stream_process_float_input(NativeHandle *handle, const float *input,
+                                    float *output, struct DenoiserResult *result) {
+    if (handle->pipeline != nullptr) {
+        return AUDX_ERROR_UNSUPPORTED;
+    }
+    return process_frame(handle, [&] {
+        return direct_process_float(handle, input, output, result);
+    });
+}
+
+int audx_stream_process_pcm(NativeHandle *handle, int format, const void *input,
+                            void *output, struct DenoiserResult *result) {
+    if (handle->pipeline != nullptr) {
+        return AUDX_ERROR_UNSUPPORTED;
+    }
+    // The float path reads its input frame before writing its output, so
+    // one scratch frame serves both
+    float *frame = handle->resampler_ctx->pcm_frame;
+    const int samples = handle->resampler_ctx->input_frame_samples;
+    if (pcm_format_to_float(format, input, frame, samples) != AUDX_SUCCESS) {
+        return AUDX_ERROR_INVALID;
+    }
+    handle->stage_timers.lap(AUDX_STAGE_CONVERT);
+    int ret = process_frame(handle, [&] {
+        return direct_process_float(handle, frame, frame, result);
+    });
+    if (ret == AUDX_SUCCESS) {
+        pcm_float_to_format(format, frame, output, samples);
+        handle->stage_timers.lap(AUDX_STAGE_CONVERT);
+    }
+    return ret;
+}
+
+void audx_stream_get_stats(const NativeHandle *handle, StreamStats *stats) {
+    uint32_t requested;
+    if (stats_readable(handle, &requested)) {
+        stats->denoiser = handle->stats_snapshot.load();
+        stats->denoise_latency = handle->denoise_latency.summarize();
+        stats->e2e_latency = handle->e2e_latency.summarize();
+        stats->resample_quality = handle->resampler_ctx->quality.load(std::memory_order_relaxed);
+        if (stats_unchanged(handle, requested)) {
+            return;
+        }
+    }
+
+    // Reset requested but not yet applied by the processing thread
+    stats->denoiser = handle->initial_stats;
+    stats->denoise_latency = LatencySummary{};
+    stats->e2e_latency = LatencySummary{};
+    stats->resample_quality = handle->resampler_ctx->quality.load(std::memory_order_relaxed);
+}
+
+void audx_stream_get_stage_timings(const NativeHandle *handle,
+                                   StageSummary stages[AUDX_STAGE_COUNT]) {
+    uint32_t requested;
+    if (stats_readable(handle, &requested)) {
+        handle->stage_timers.summarize(stages);
+        if (stats_unchanged(handle, requested)) {
+            return;
+        }
+    }
+
+    for (int i = 0; i < AUDX_STAGE_COUNT; i++) {
+        stages[i] = StageSummary{};
+    }
+}
+
+void audx_stream_reset_stats(NativeHandle *handle) {
+    handle->stats_reset_requested.fetch_add(1, std::memory_order_release);
+}
+
+int audx_stream_start_pipeline(NativeHandle *handle) {
+    if (handle->pipeline != nullptr) {
+        return AUDX_SUCCESS;
+    }
+
+    auto *pipeline = new(std::nothrow) StreamPipeline();
+    if (pipeline == nullptr) {
+        return AUDX_ERROR_MEMORY;
+    }
+    handle->pipeline = pipeline;
+    handle->features->enabled = false;
+    handle->features->gains_enabled = false;
+
+    try {
+        pipeline->worker = std::thread(pipeline_worker, handle);
+    } catch (const std::system_error &e) {
+        AUDX_LOGE("Failed to start inference thread: %s", e.what());
+        handle->pipeline = nullptr;
+        delete pipeline;
+        return AUDX_ERROR_MEMORY;
+    }
+    return AUDX_SUCCESS;
+}
+
+int audx_stream_set_input_rate(NativeHandle *handle, int input_rate) {
+    ResamplerContext *resampler_ctx = handle->resampler_ctx;
+    if (input_rate == resampler_ctx->input_rate) {
+        return AUDX_SUCCESS;
+    }
+    if (input_rate < kMinInputRate || input_rate > resampler_ctx->max_input_rate) {
+        return AUDX_ERROR_INVALID;
+    }
+
+    if (input_rate != AUDX_DEFAULT_SAMPLE_RATE) {
+        if (resampler_ctx->upsampler == nullptr) {
+            // Created at 48kHz: first switch away from it
+            int err;
+            AudxResampler upsampler = audx_resample_create(
+                    1, input_rate, AUDX_DEFAULT_SAMPLE_RATE, resampler_ctx->quality, &err);
+            AudxResampler downsampler = audx_resample_create(
+                    1, AUDX_DEFAULT_SAMPLE_RATE, input_rate, resampler_ctx->quality, &err);
+            if (upsampler == nullptr || downsampler == nullptr) {
+                audx_resample_destroy(upsampler);
+                audx_resample_destroy(downsampler);
+                return AUDX_ERROR_MEMORY;
+            }
+            resampler_ctx->upsampler = upsampler;
+            resampler_ctx->downsampler = downsampler;
+        } else {
+            auto *upsampler = static_cast<SpeexResamplerState *>(resampler_ctx->upsampler);
+            auto *downsampler = static_cast<SpeexResamplerState *>(resampler_ctx->downsampler);
+            if (speex_resampler_set_rate(upsampler, input_rate, AUDX_DEFAULT_SAMPLE_RATE) !=
+                        RESAMPLER_ERR_SUCCESS ||
+                speex_resampler_set_rate(downsampler, AUDX_DEFAULT_SAMPLE_RATE, input_rate) !=
+                        RESAMPLER_ERR_SUCCESS) {
+                return AUDX_ERROR_MEMORY;
+            }
+            // Their memories hold audio at the old rate
+            reset_resampler(resampler_ctx->upsampler);
+            reset_resampler(resampler_ctx->downsampler);
+        }
+    }
+
+    configure_input_rate(resampler_ctx, input_rate);
+    return AUDX_SUCCESS;
+}
+
+int audx_stream_set_adaptive_quality(NativeHandle *handle, int min_quality, int max_quality) {
+    if (min_quality < AUDX_RESAMPLER_QUALITY_MIN || max_quality > AUDX_RESAMPLER_QUALITY_MAX ||
+        min_quality > max_quality) {
+        return AUDX_ERROR_INVALID;
+    }
+
+    ResamplerContext *resampler_ctx = handle->resampler_ctx;
+    const int quality = std::min(std::max((int) resampler_ctx->quality, min_quality), max_quality);
+    if (quality != resampler_ctx->quality && !set_resampler_quality(resampler_ctx, quality)) {
+        return AUDX_ERROR_MEMORY;
+    }
+
+    AdaptiveQuality &adaptive = resampler_ctx->adaptive;
+    adaptive.enabled = true;
+    adaptive.min_quality = min_quality;
+    adaptive.max_quality = max_quality;
+    adaptive.base_quality = quality;
+    adaptive.window_ns = 0;
+    adaptive.window_frames = 0;
+    adaptive.headroom_windows = 0;
+    return AUDX_SUCCESS;
+}
+
+int audx_stream_set_resample_quality(NativeHandle *handle, int quality) {
+    if (quality < AUDX_RESAMPLER_QUALITY_MIN || quality > AUDX_RESAMPLER_QUALITY_MAX) {
+        return AUDX_ERROR_INVALID;
+    }
+
+    ResamplerContext *resampler_ctx = handle->resampler_ctx;
+    if (quality != resampler_ctx->quality && !set_resampler_quality(resampler_ctx, quality)) {
+        return AUDX_ERROR_MEMORY;
+    }
+    resampler_ctx->adaptive.enabled = false;
+    return AUDX_SUCCESS;
+}
+
+int audx_stream_set_band_features(NativeHandle *handle, bool enabled) {
+    if (handle->pipeline != nullptr) {
+        return AUDX_ERROR_UNSUPPORTED;
+    }
+    FeatureContext *features = handle->features;
+    // The output window is already running if gains are on
+    if (enabled && !features->enabled && !features->gains_enabled) {
+        reset_output_analysis(features);
+    }
+    features->enabled = enabled;
+    return AUDX_SUCCESS;
+}
+
+const BandFeatures *audx_stream_band_features(const NativeHandle *handle) {
+    return handle->features->enabled ? &handle->features->output : nullptr;
+}
+
+int audx_stream_set_band_gains(NativeHandle *handle, bool enabled) {
+    if (handle->pipeline != nullptr) {
+        return AUDX_ERROR_UNSUPPORTED;
+    }
+    FeatureContext *features = handle->features;
+    if (enabled && !features->gains_enabled) {
+        reset_gain_analysis(features);
+        if (!features->enabled) {
+            reset_output_analysis(features);
+        }
+    }
+    features->gains_enabled = enabled;
+    return AUDX_SUCCESS;
+}
+
+const BandGains *audx_stream_band_gains(const NativeHandle *handle) {
+    return handle->features->gains_enabled ? &handle->features->gains : nullptr;
+}
+
+void audx_stream_reset(NativeHandle *handle) {
+    StreamPipeline *pipeline = handle->pipeline;
+    if (pipeline != nullptr && pipeline->in_flight) {
+        // Wait for the inference thread and drop its frame; the next frame
+        // starts the pipeline over with a silent one
+        uint32_t done_index;
+        pipeline->to_caller.pop_wait(done_index, pipeline->stop);
+        pipeline->fill_slot = done_index;
+        pipeline->in_flight = false;
+    }
+
+    denoiser_reset(handle->denoiser);
+
+    ResamplerContext *resampler_ctx = handle->resampler_ctx;
+    if (resampler_ctx->needs_resampling) {
+        reset_resampler(resampler_ctx->upsampler);
+        reset_resampler(resampler_ctx->downsampler);
+        resampler_ctx->upsampler_history.count = 0;
+        resampler_ctx->upsampler_history.next = 0;
+        resampler_ctx->downsampler_history.count = 0;
+        resampler_ctx->downsampler_history.next = 0;
+    }
+
+    AdaptiveQuality &adaptive = resampler_ctx->adaptive;
+    if (adaptive.enabled) {
+        if (resampler_ctx->quality != adaptive.base_quality) {
+            set_resampler_quality(resampler_ctx, adaptive.base_quality);
+        }
+        adaptive.window_ns = 0;
+        adaptive.window_frames = 0;
+        adaptive.headroom_windows = 0;
+    }
+
+    reset_band_analysis(handle->features);
+
+    audx_stream_reset_stats(handle);
+    apply_pending_stats_reset(handle);
+}
+
+size_t audx_stream_state_size_bound(const NativeHandle *handle) {
+    const ResamplerContext *resampler_ctx = handle->resampler_ctx;
+    size_t history_samples = 0;
+    if (resampler_ctx->needs_resampling) {
+        const FrameHistory &up = resampler_ctx->upsampler_history;
+        const FrameHistory &down = resampler_ctx->downsampler_history;
+        history_samples = (size_t) up.capacity * up.frame_samples +
+                          (size_t) down.capacity * down.frame_samples;
+    }
+    return kStateHeaderBytes + history_samples * sizeof(float) +
+           denoiser_state_size_bound();
+}
+
+int audx_stream_save_state(const NativeHandle *handle, uint8_t *buf,
+                           size_t capacity, size_t *size) {
+    if (handle->pipeline != nullptr) {
+        // The inference thread may be mid-frame
+        return AUDX_ERROR_UNSUPPORTED;
+    }
+    if (capacity < audx_stream_state_size_bound(handle)) {
+        return AUDX_ERROR_INVALID;
+    }
+
+    const ResamplerContext *resampler_ctx = handle->resampler_ctx;
+    const FrameHistory *histories[2] = {&resampler_ctx->upsampler_history,
+                                        &resampler_ctx->downsampler_history};
+    uint32_t header[kStateHeaderWords] = {
+            kStateMagic, kStateVersion, (uint32_t) resampler_ctx->input_rate,
+            (uint32_t) resampler_ctx->quality.load(std::memory_order_relaxed), 0, 0};
+
+    uint8_t *p = buf + kStateHeaderBytes;
+    if (resampler_ctx->needs_resampling) {
+        for (int h = 0; h < 2; h++) {
+            const FrameHistory *history = histories[h];
+            size_t frame_bytes = history->frame_samples * sizeof(float);
+            header[kStateHistoryWord + h] = (uint32_t) history->count;
+            for (int i = 0; i < history->count; i++) {
+                memcpy(p, history_frame(history, i), frame_bytes);
+                p += frame_bytes;
+            }
+        }
+    }
+    memcpy(buf, header, kStateHeaderBytes);
+
+    size_t denoiser_size;
+    int ret = denoiser_save_state(handle->denoiser, p, capacity - (p - buf), &denoiser_size);
+    if (ret != AUDX_SUCCESS) {
+        return ret;
+    }
+    *size = (p - buf) + denoiser_size;
+    return AUDX_SUCCESS;
+}
+
+int audx_stream_restore_state(NativeHandle *handle, const uint8_t *buf, size_t size) {
+    if (handle->pipeline != nullptr) {
+        return AUDX_ERROR_UNSUPPORTED;
+    }
+
+    ResamplerContext *resampler_ctx = handle->resampler_ctx;
+    uint32_t header[kStateHeaderWords];
+    if (size < kStateHeaderBytes) {
+        return AUDX_ERROR_INVALID;
+    }
+    memcpy(header, buf, kStateHeaderBytes);
+    if (header[0] != kStateMagic || header[1] != kStateVersion ||
+        header[2] != (uint32_t) resampler_ctx->input_rate ||
+        header[3] > (uint32_t) AUDX_RESAMPLER_QUALITY_MAX) {
+        AUDX_LOGE("Incompatible state (version %u, rate %u, quality %u)",
+                  header[1], header[2], header[3]);
+        return AUDX_ERROR_INVALID;
+    }
+    // The filter length depends on the quality, so the history is replayed
+    // at the quality it was recorded with, which the stream then keeps
+    const int quality = (int) header[3];
+
+    // Stage everything first so a bad blob leaves the stream untouched
+    FrameHistory *histories[2] = {&resampler_ctx->upsampler_history,
+                                  &resampler_ctx->downsampler_history};
+    std::vector<float> staged[2];
+    const uint8_t *p = buf + kStateHeaderBytes;
+    for (int h = 0; h < 2; h++) {
+        uint32_t count = header[kStateHistoryWord + h];
+        if (!resampler_ctx->needs_resampling) {
+            if (count != 0) {
+                return AUDX_ERROR_INVALID;
+            }
+            continue;
+        }
+        if (count > (uint32_t) histories[h]->capacity) {
+            return AUDX_ERROR_INVALID;
+        }
+        size_t samples = (size_t) count * histories[h]->frame_samples;
+        if (samples * sizeof(float) > size - (p - buf)) {
+            return AUDX_ERROR_INVALID;
+        }
+        staged[h].resize(samples);
+        memcpy(staged[h].data(), p, samples * sizeof(float));
+        p += samples * sizeof(float);
+    }
+
+    // Speex resampler state is opaque: replay the history through fresh
+    // resamplers, which leaves their filter memory and phase exactly where
+    // the saved stream's were
+    AudxResampler upsampler = nullptr;
+    AudxResampler downsampler = nullptr;
+    int ret = AUDX_SUCCESS;
+    if (resampler_ctx->needs_resampling) {
+        const int in_frame = resampler_ctx->input_frame_samples;
+        const int out_frame = resampler_ctx->output_frame_samples;
+        upsampler = audx_resample_create(1, resampler_ctx->input_rate,
+                                         AUDX_DEFAULT_SAMPLE_RATE, quality, &ret);
+        downsampler = audx_resample_create(1, AUDX_DEFAULT_SAMPLE_RATE,
+                                           resampler_ctx->input_rate, quality, &ret);
+        std::vector<float> discard(std::max(in_frame, out_frame));
+        if (upsampler == nullptr || downsampler == nullptr) {
+            ret = AUDX_ERROR_MEMORY;
+        } else {
+            ret = replay_history(upsampler, staged[0].data(), (int) header[kStateHistoryWord],
+                                 in_frame, discard.data(), out_frame);
+        }
+        if (ret == AUDX_SUCCESS) {
+            ret = replay_history(downsampler, staged[1].data(), (int) header[kStateHistoryWord + 1],
+                                 out_frame, discard.data(), in_frame);
+        }
+    }
+
+    size_t consumed;
+    if (ret == AUDX_SUCCESS) {
+        ret = denoiser_restore_state(handle->denoiser, p, size - (p - buf), &consumed);
+    }
+    if (ret != AUDX_SUCCESS) {
+        audx_resample_destroy(upsampler);
+        audx_resample_destroy(downsampler);
+        return ret;
+    }
+
+    if (resampler_ctx->needs_resampling) {
+        audx_resample_destroy(resampler_ctx->upsampler);
+        audx_resample_destroy(resampler_ctx->downsampler);
+        resampler_ctx->upsampler = upsampler;
+        resampler_ctx->downsampler = downsampler;
+        for (int h = 0; h < 2; h++) {
+            FrameHistory *history = histories[h];
+            memcpy(history->frames, staged[h].data(), staged[h].size() * sizeof(float));
+            history->count = (int) header[kStateHistoryWord + h];
+            history->next = history->count % history->capacity;
+        }
+    }
+    resampler_ctx->quality.store(quality, std::memory_order_relaxed);
+    return AUDX_SUCCESS;
+}
+
+void audx_stream_destroy(NativeHandle *handle) {
+    if (handle == nullptr) {
+        return;
+    }
+
+    if (handle->pipeline != nullptr) {
+        handle->pipeline->stop.store(true, std::memory_order_release);
+        handle->pipeline->to_worker.wake();
+        handle->pipeline->worker.join();
+        delete handle->pipeline;
+    }
+
+    destroy_arena_denoiser(handle->denoiser);
+    audx_resample_destroy(handle->resampler_ctx->upsampler);
+    audx_resample_destroy(handle->resampler_ctx->downsampler);
+
+    // The handle is the start of the arena
+    const bool owns_arena = handle->owns_arena;
+    handle->~NativeHandle();
+    if (owns_arena) {
+        free(handle);
+    }
+}
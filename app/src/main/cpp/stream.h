@@ -0,0 +1,439 @@
+#ifndef AUDX_STREAM_H
+#define AUDX_STREAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "band_features.h"
+#include "latency_histogram.h"
+#include "seqlock.h"
+#include "stage_timers.h"
+
+extern "C" {
+#include "audx/denoiser.h"
+#include "audx/common.h"
+#include "audx/resample.h"
+}
+
+/**
+ * Ring of the most recent frames fed to a resampler. The Speex resampler
+ * state is not serializable, so audx_stream_save_state() stores these and
+ * audx_stream_restore_state() replays them through a fresh resampler.
+ * Frames are kept as the float values the resampler worked on, so int16,
+ * float and 24/32-bit input all replay exactly.
+ */
+struct FrameHistory {
+    float *frames;        // capacity * frame_samples samples
+    int frame_samples;
+    int capacity;         // Frames; covers the longest resampler filter
+    int next;             // Slot for the next frame
+    int count;            // Valid frames, up to capacity
+};
+
+/**
+ * Adaptive resampler quality (audx_stream_set_adaptive_quality()). Only
+ * touched by the processing thread, at frame boundaries.
+ */
+struct AdaptiveQuality {
+    bool enabled;
+    int min_quality;
+    int max_quality;
+    int base_quality;         // Starting quality, restored by audx_stream_reset()
+    uint64_t window_ns;       // Frame time accumulated over the current window
+    int window_frames;
+    int headroom_windows;     // Consecutive windows cheap enough to step up
+};
+
+/**
+ * Resampler context struct to hold resampling state
+ */
+struct ResamplerContext {
+    int input_rate;
+    int max_input_rate;           // Highest rate audx_stream_set_input_rate() accepts
+    int output_rate;
+    std::atomic<int> quality;     // Written by the processing thread, read by stats readers
+    bool needs_resampling;
+    int input_frame_samples;
+    int output_frame_samples;
+    AudxResampler upsampler;      // Persistent upsampler (input_rate -> 48kHz); null until first needed
+    AudxResampler downsampler;    // Persistent downsampler (48kHz -> input_rate)
+    int16_t *resampled_input;     // Persistent 48kHz scratch frame (upsampler output)
+    int16_t *resampled_output;    // Persistent 48kHz scratch frame (denoiser output)
+    float *pcm_frame;             // Input-rate float frame for audx_stream_process_pcm()
+    FrameHistory upsampler_history;     // Input frames
+    FrameHistory downsampler_history;   // 48kHz denoiser output frames
+    AdaptiveQuality adaptive;
+};
+
+/**
+ * Band features of the denoised output (audx_stream_set_band_features())
+ * and band gains (audx_stream_set_band_gains()). Only touched by the
+ * processing thread.
+ */
+struct FeatureContext {
+    bool enabled;                 // Band features
+    bool gains_enabled;
+    BandAnalyzer output_analyzer;
+    BandAnalyzer input_analyzer;  // Band gains only
+    BandFeatures output;          // Most recent frame; band_energy also feeds the gains
+    BandGains gains;              // Most recent frame
+    float input_energy[AUDX_NB_BANDS];      // Current input frame
+    float delayed_energy[AUDX_NB_BANDS];    // Previous input frame, aligned with the output
+    float noise_energy;           // Noise floor tracker (band_gains())
+};
+
+struct StreamPipeline;
+
+/**
+ * Combined native handle containing both denoiser and resampler context
+ *
+ * This is the per-stream object behind the Kotlin AudxDenoiser. It carries no
+ * JNI state, so the same pipeline is driven by native-lib.cpp on Android and
+ * by the host benchmark driver.
+ *
+ * The Denoiser counters are only ever touched by the thread calling
+ * audx_stream_process(). Other threads see statistics through
+ * stats_snapshot, which the processing thread republishes after every frame,
+ * and request resets through stats_reset_requested, which the processing
+ * thread applies at the next frame boundary.
+ *
+ * The handle is the head of the stream's arena (see audx_stream_create()).
+ * Fields read on every frame come first; the fields other threads write sit
+ * on their own cache lines so polling statistics never invalidates them.
+ */
+struct NativeHandle {
+    Denoiser *denoiser;
+    ResamplerContext *resampler_ctx;
+
+    // Non-null in pipelined mode (audx_stream_start_pipeline())
+    StreamPipeline *pipeline;
+
+    FeatureContext *features;
+
+    // Optional per-stage breakdown, toggled at runtime. The caller brackets
+    // each frame with begin_frame()/end_frame(); audx_stream_process() laps
+    // the resampling and denoising stages in between.
+    StageTimers stage_timers;
+
+    // Per-frame latency, recorded by the processing thread when statistics
+    // are enabled
+    LatencyHistogram denoise_latency;   // denoiser_process() (or its float variant) alone
+    LatencyHistogram e2e_latency;       // Whole frame as seen by the caller (see native-lib.cpp)
+
+    alignas(64) Seqlock<DenoiserStats> stats_snapshot;
+    alignas(64) std::atomic<uint32_t> stats_reset_requested{0};   // Bumped by audx_stream_reset_stats()
+    std::atomic<uint32_t> stats_reset_applied{0};     // Last request applied by the processing thread
+
+    alignas(64) DenoiserStats initial_stats;          // Stats of a freshly reset denoiser
+
+    bool owns_arena;    // False when the caller supplied the storage (audx_stream_create_in())
+};
+
+/**
+ * Statistics snapshot returned by audx_stream_get_stats()
+ */
+struct StreamStats {
+    struct DenoiserStats denoiser;
+    LatencySummary denoise_latency;
+    LatencySummary e2e_latency;
+    int resample_quality;     // Current resampler quality
+};
+
+/**
+ * @brief Create a stream: denoiser plus persistent resamplers
+ *
+ * The handle, resampler context, Denoiser, RNNoise state and all scratch
+ * buffers share one 64-byte-aligned allocation, laid out in the order the
+ * frame path touches them, with cold data (the Denoiser's error text, the
+ * frame histories) at the end. Only the two Speex resampler states are
+ * separate allocations.
+ *
+ * The core has no entry point that takes caller storage, so the Denoiser is
+ * set up with denoiser_create() and its RNNoise state and frame buffer are
+ * then replaced by arena blocks. This relies on denoiser_create() allocating
+ * exactly those two with rnnoise_create() and a calloc() of
+ * AUDX_DEFAULT_FRAME_SIZE floats, on no other core object pointing at them,
+ * and on denoiser_destroy() skipping null members. The arena block sizes
+ * come from rnnoise_get_size() and are checked against
+ * rnnoise_get_frame_size() at creation, which fails with
+ * AUDX_ERROR_UNSUPPORTED if the core does not match. The two core
+ * allocations are still made and freed once per stream, at creation; the
+ * frame path never touches them.
+ *
+ * @param config       Denoiser configuration (must not be NULL)
+ * @param input_rate   Sample rate of the audio fed to audx_stream_process()
+ * @param quality      Resampler quality (0-10), unused for 48kHz input
+ * @param err          Optional pointer to receive an AUDX_* error code
+ *
+ * @return New stream handle, or nullptr on failure
+ */
+NativeHandle *audx_stream_create(const struct DenoiserConfig *config,
+                                 int input_rate, int quality, int *err);
+
+/**
+ * @brief Arena size in bytes of a stream created at input_rate
+ *
+ * Always a multiple of 64, so arenas can be packed back to back.
+ */
+size_t audx_stream_arena_size(int input_rate);
+
+/**
+ * @brief audx_stream_create() in caller-supplied storage
+ *
+ * arena must be 64-byte aligned and hold audx_stream_arena_size(input_rate)
+ * bytes. audx_stream_destroy() tears the stream down but leaves the storage
+ * to the caller, which frees it only after the stream is destroyed.
+ *
+ * @return New stream handle (at the start of arena), or nullptr on failure
+ */
+NativeHandle *audx_stream_create_in(void *arena, const struct DenoiserConfig *config,
+                                    int input_rate, int quality, int *err);
+
+/**
+ * @brief Denoise one 10 ms frame at the stream's input rate
+ *
+ * Upsamples to 48kHz when needed, runs the denoiser and downsamples back.
+ * input and output hold input_frame_samples samples each.
+ *
+ * @return AUDX_SUCCESS on success, negative error code on failure
+ */
+int audx_stream_process(NativeHandle *handle, const int16_t *input,
+                        int16_t *output, struct DenoiserResult *result);
+
+/**
+ * @brief audx_stream_process() with float output
+ *
+ * The denoised frame is handed out before int16 conversion, normalized to
+ * [-1, 1] and not clipped. At 48kHz it is the denoiser output itself; other
+ * rates are downsampled in float. output holds input_frame_samples floats.
+ *
+ * @return AUDX_SUCCESS, AUDX_ERROR_UNSUPPORTED in pipelined mode, or a
+ *         negative error code on failure
+ */
+int audx_stream_process_float(NativeHandle *handle, const int16_t *input,
+                              float *output, struct DenoiserResult *result);
+
+/**
+ * @brief audx_stream_process_float() with float input
+ *
+ * input holds input_frame_samples floats normalized to [-1, 1]. It is
+ * upsampled in float and scaled straight into the denoiser's frame buffer,
+ * with no int16 round trip.
+ *
+ * @return AUDX_SUCCESS, AUDX_ERROR_UNSUPPORTED in pipelined mode, or a
+ *         negative error code on failure
+ */
+int audx_stream_process_float_input(NativeHandle *handle, const float *input,
+                                    float *output, struct DenoiserResult *result);
+
+/**
+ * @brief Denoise one frame of 24- or 32-bit integer PCM
+ *
+ * Converts input (an AudxPcmFormat, see pcm_convert.h) to float, runs it
+ * through audx_stream_process_float_input() and converts the result back to
+ * the same format, so no precision is lost to int16 on the way. input and
+ * output hold input_frame_samples samples each and may be the same buffer.
+ *
+ * @return AUDX_SUCCESS, AUDX_ERROR_INVALID for an unknown format,
+ *         AUDX_ERROR_UNSUPPORTED in pipelined mode, or a negative error code
+ *         on failure
+ */
+int audx_stream_process_pcm(NativeHandle *handle, int format, const void *input,
+                            void *output, struct DenoiserResult *result);
+
+/**
+ * @brief Change the input sample rate of a running stream
+ *
+ * Takes effect with the next frame; call on the processing thread, between
+ * frames. The RNNoise state is kept, so denoising continues without
+ * re-converging. The resamplers are retuned in place with
+ * speex_resampler_set_rate() and their memories cleared, since they hold
+ * audio at the old rate. Frames are input_frame_samples of the new rate from
+ * then on; in pipelined mode that includes the frame in flight.
+ *
+ * The frame histories and scratch frames are sized at creation for every
+ * rate from 8 kHz to max_input_rate, so nothing is allocated, except that a
+ * stream created at 48 kHz creates its resamplers on its first switch.
+ *
+ * @return AUDX_SUCCESS, AUDX_ERROR_INVALID for a rate outside
+ *         8000..max_input_rate, or AUDX_ERROR_MEMORY
+ */
+int audx_stream_set_input_rate(NativeHandle *handle, int input_rate);
+
+/**
+ * @brief Let the stream pick its resampler quality from measured frame time
+ *
+ * Once enabled, the processing thread measures the real-time factor (frame
+ * time over the 10 ms frame duration) over one-second windows. A window above
+ * 0.5 steps the upsampler and downsampler one quality level down with
+ * speex_resampler_set_quality(); five consecutive windows below 0.25 step it
+ * one level up. The gap between the two thresholds keeps the quality from
+ * oscillating between neighbouring levels. The current quality is reported in
+ * StreamStats::resample_quality.
+ *
+ * The quality is first clamped to [min_quality, max_quality]. Has no effect
+ * while the input is 48kHz. Call on the processing thread, between frames.
+ *
+ * @return AUDX_SUCCESS, or AUDX_ERROR_INVALID unless
+ *         0 <= min_quality <= max_quality <= 10
+ */
+int audx_stream_set_adaptive_quality(NativeHandle *handle, int min_quality, int max_quality);
+
+/**
+ * @brief Set a fixed resampler quality, turning adaptive quality off
+ *
+ * Keeps the resampler memories. Call on the processing thread, between
+ * frames.
+ *
+ * @return AUDX_SUCCESS, AUDX_ERROR_INVALID unless 0 <= quality <= 10, or
+ *         AUDX_ERROR_MEMORY if the resamplers could not be changed
+ */
+int audx_stream_set_resample_quality(NativeHandle *handle, int quality);
+
+/**
+ * @brief Turn per-frame band features of the denoised output on or off
+ *
+ * While enabled, every frame processed outside pipelined mode is analyzed at
+ * 48kHz after denoising (see band_features.h): 22 band energies and the
+ * matching cepstral features, read back with audx_stream_band_features().
+ * The analysis costs one 960-point FFT per frame; disabled, it costs a
+ * branch. Enabling clears the analysis window unless band gains already
+ * keep it running; audx_stream_reset() always clears it. Call on the
+ * processing thread, between frames.
+ *
+ * @return AUDX_SUCCESS, or AUDX_ERROR_UNSUPPORTED in pipelined mode
+ */
+int audx_stream_set_band_features(NativeHandle *handle, bool enabled);
+
+/**
+ * @brief Band features of the last frame processed
+ *
+ * Valid until the next frame. Call on the processing thread.
+ *
+ * @return The features, or nullptr while they are disabled
+ */
+const BandFeatures *audx_stream_band_features(const NativeHandle *handle);
+
+/**
+ * @brief Turn per-frame band gains, SNR and noise floor on or off
+ *
+ * While enabled, the 48kHz frame is analyzed before and after denoising
+ * (one extra 960-point FFT per frame, the output analysis being shared with
+ * band features) and band_gains() compares the two. RNNoise's own gains are
+ * internal to its state, so these are measured after the fact: the square
+ * root of each band's output energy over its input energy, not clamped (it
+ * can exceed 1 where denoising added energy). The input is taken one frame
+ * late to match RNNoise's 10 ms synthesis delay. Disabled, it costs a
+ * branch. Enabling clears the input analysis, the delayed energies and the
+ * noise floor, and the output analysis only if band features are off;
+ * audx_stream_reset() clears all of it. Call on the processing thread,
+ * between frames.
+ *
+ * @return AUDX_SUCCESS, or AUDX_ERROR_UNSUPPORTED in pipelined mode
+ */
+int audx_stream_set_band_gains(NativeHandle *handle, bool enabled);
+
+/**
+ * @brief Band gains of the last frame processed
+ *
+ * Valid until the next frame. Call on the processing thread.
+ *
+ * @return The gains, or nullptr while they are disabled
+ */
+const BandGains *audx_stream_band_gains(const NativeHandle *handle);
+
+/**
+ * @brief Switch a stream to pipelined mode
+ *
+ * Starts an inference thread: the calling thread resamples frame N while the
+ * inference thread denoises frame N-1, connected by lock-free SPSC queues.
+ * This adds one frame (10 ms) of latency: each audx_stream_process() call
+ * returns the previous frame, and the first call returns silence.
+ *
+ * Must be called before the first frame. Turns band features and gains off.
+ *
+ * @return AUDX_SUCCESS, or AUDX_ERROR_MEMORY if the thread cannot be started
+ */
+int audx_stream_start_pipeline(NativeHandle *handle);
+
+/**
+ * @brief Return a stream to its just-created state without reallocating
+ *
+ * Re-initializes the RNNoise state in place (denoiser_reset()), clears the
+ * resampler memories and frame histories, returns an adaptive resampler
+ * quality to its starting level, clears the band analysis and noise floor
+ * and resets statistics. In pipelined mode
+ * the frame in flight is dropped. Call on the processing thread, between
+ * frames.
+ */
+void audx_stream_reset(NativeHandle *handle);
+
+/**
+ * @brief Upper bound on the size written by audx_stream_save_state()
+ */
+size_t audx_stream_state_size_bound(const NativeHandle *handle);
+
+/**
+ * @brief Serialize the stream's denoiser and resampler state
+ *
+ * Writes a versioned blob that audx_stream_restore_state() loads into
+ * another stream with the same input rate and model, which then continues
+ * with bit-identical output. The blob records the current resampler quality
+ * (which may have been changed by adaptive quality), and the restored stream
+ * takes it over. Statistics are not included. Call on the processing thread,
+ * between frames.
+ *
+ * @return AUDX_SUCCESS, AUDX_ERROR_INVALID if buf is too small, or
+ *         AUDX_ERROR_UNSUPPORTED in pipelined mode
+ */
+int audx_stream_save_state(const NativeHandle *handle, uint8_t *buf,
+                           size_t capacity, size_t *size);
+
+/**
+ * @brief Load a blob written by audx_stream_save_state()
+ *
+ * The resamplers are rebuilt at the quality stored in the blob, and the
+ * stream keeps that quality afterwards. Call on the processing thread,
+ * between frames. The stream is left unchanged on failure.
+ *
+ * @return AUDX_SUCCESS, AUDX_ERROR_INVALID for a malformed blob or one saved
+ *         at another input rate, AUDX_ERROR_UNSUPPORTED in pipelined mode,
+ *         or AUDX_ERROR_MEMORY
+ */
+int audx_stream_restore_state(NativeHandle *handle, const uint8_t *buf, size_t size);
+
+/**
+ * @brief Read a consistent statistics snapshot
+ *
+ * Lock-free and safe to call from any thread, concurrently with
+ * audx_stream_process(). Reflects pending resets immediately.
+ */
+void audx_stream_get_stats(const NativeHandle *handle, StreamStats *stats);
+
+/**
+ * @brief Read the per-stage timing breakdown
+ *
+ * Same threading and reset semantics as audx_stream_get_stats().
+ */
+void audx_stream_get_stage_timings(const NativeHandle *handle,
+                                   StageSummary stages[AUDX_STAGE_COUNT]);
+
+/**
+ * @brief Reset statistics
+ *
+ * Safe to call from any thread. The counters are cleared by the processing
+ * thread before its next frame; snapshots read after this call already
+ * report the reset values.
+ */
+void audx_stream_reset_stats(NativeHandle *handle);
+
+/**
+ * @brief Destroy a stream created by audx_stream_create() or
+ *        audx_stream_create_in()
+ *
+ * Accepts nullptr. Frees the arena only if the stream allocated it.
+ */
+void audx_stream_destroy(NativeHandle *handle);
+
+#endif // AUDX_STREAM_H
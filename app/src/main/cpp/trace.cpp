@@ -0,0 +1,136 @@
+#include "trace.h"
+
+#ifdef AUDX_TRACING
+
+std::atomic<bool> g_audx_trace_enabled{false};
+
+void audx_trace_set_enabled(bool enabled) {
+    g_audx_trace_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+#ifdef AUDX_ANDROID
+
+#include <android/trace.h>
+#include <dlfcn.h>
+
+namespace {
+
+// ATrace_setCounter is API 29; minSdk is 24, so resolve it at runtime
+using SetCounterFn = void (*)(const char *, int64_t);
+
+SetCounterFn resolve_set_counter() {
+    void *lib = dlopen("libandroid.so", RTLD_NOW | RTLD_NOLOAD);
+    if (lib == nullptr) {
+        return nullptr;
+    }
+    return reinterpret_cast<SetCounterFn>(dlsym(lib, "ATrace_setCounter"));
+}
+
+}  // namespace
+
+bool audx_trace_active() {
+    return ATrace_isEnabled();
+}
+
+void audx_trace_begin(const char *name) {
+    ATrace_beginSection(name);
+}
+
+void audx_trace_end() {
+    ATrace_endSection();
+}
+
+void audx_trace_counter(const char *name, int64_t value) {
+    static const SetCounterFn set_counter = resolve_set_counter();
+    if (set_counter != nullptr) {
+        set_counter(name, value);
+    }
+}
+
+#else  // Host: Chrome trace-event JSON
+
+#include <cinttypes>
+#include <cstdio>
+#include <mutex>
+#include <unistd.h>
+
+#include "latency_histogram.h"
+
+namespace {
+
+std::mutex g_trace_mutex;
+FILE *g_trace_file = nullptr;          // Guarded by g_trace_mutex
+bool g_trace_first_event = true;       // Guarded by g_trace_mutex
+uint64_t g_trace_origin_ns = 0;
+std::atomic<bool> g_trace_file_open{false};
+std::atomic<int> g_next_tid{1};
+
+int current_tid() {
+    thread_local int tid = g_next_tid.fetch_add(1, std::memory_order_relaxed);
+    return tid;
+}
+
+/** Write one event; body is the JSON members after name/ph/ts/pid/tid */
+void write_event(const char *name, char phase, const char *body) {
+    double ts_us = (double) (latency_clock_ns() - g_trace_origin_ns) / 1000.0;
+    int tid = current_tid();
+
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+    if (g_trace_file == nullptr) {
+        return;
+    }
+    fprintf(g_trace_file, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d%s}",
+            g_trace_first_event ? "\n" : ",\n", name, phase, ts_us, (int) getpid(), tid, body);
+    g_trace_first_event = false;
+}
+
+}  // namespace
+
+bool audx_trace_open(const char *path) {
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+    if (g_trace_file != nullptr) {
+        fclose(g_trace_file);
+    }
+    g_trace_file = fopen(path, "w");
+    if (g_trace_file == nullptr) {
+        g_trace_file_open.store(false, std::memory_order_relaxed);
+        return false;
+    }
+    fputs("[", g_trace_file);
+    g_trace_first_event = true;
+    g_trace_origin_ns = latency_clock_ns();
+    g_trace_file_open.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void audx_trace_close() {
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+    g_trace_file_open.store(false, std::memory_order_relaxed);
+    if (g_trace_file != nullptr) {
+        fputs("\n]\n", g_trace_file);
+        fclose(g_trace_file);
+        g_trace_file = nullptr;
+    }
+}
+
+bool audx_trace_active() {
+    return g_trace_file_open.load(std::memory_order_relaxed);
+}
+
+void audx_trace_begin(const char *name) {
+    write_event(name, 'B', "");
+}
+
+void audx_trace_end() {
+    write_event("", 'E', "");
+}
+
+void audx_trace_counter(const char *name, int64_t value) {
+    char body[64];
+    snprintf(body, sizeof(body), ",\"args\":{\"value\":%" PRId64 "}", value);
+    write_event(name, 'C', body);
+}
+
+#endif // AUDX_ANDROID
+
+#endif // AUDX_TRACING
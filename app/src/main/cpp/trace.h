@@ -0,0 +1,88 @@
+#ifndef AUDX_TRACE_H
+#define AUDX_TRACE_H
+
+#include <cstdint>
+
+/**
+ * Trace-event instrumentation for the processing pipeline.
+ *
+ * On Android events go to ATrace, so they show up in Perfetto/systrace next
+ * to scheduler and GC activity. On the host they are written as Chrome
+ * trace-event JSON (chrome://tracing, ui.perfetto.dev) to the file passed to
+ * audx_trace_open().
+ *
+ * Tracing is off until audx_trace_set_enabled(true). While off, each trace
+ * point costs one relaxed load. Building without AUDX_TRACING (CMake option
+ * AUDX_ENABLE_TRACING=OFF) compiles every trace point to nothing.
+ *
+ * Use AUDX_TRACE_SCOPE() for sections: it decides once whether the section is
+ * traced, so toggling tracing mid-section never leaves begin/end unbalanced.
+ */
+
+#ifdef AUDX_TRACING
+
+#include <atomic>
+
+extern std::atomic<bool> g_audx_trace_enabled;
+
+void audx_trace_set_enabled(bool enabled);
+
+/** True when enabled and the platform sink is recording */
+bool audx_trace_active();
+
+void audx_trace_begin(const char *name);
+void audx_trace_end();
+void audx_trace_counter(const char *name, int64_t value);
+
+#ifndef AUDX_ANDROID
+/**
+ * Start writing Chrome trace-event JSON to path. Returns false if the file
+ * cannot be created. audx_trace_close() finishes the file.
+ */
+bool audx_trace_open(const char *path);
+void audx_trace_close();
+#endif
+
+static inline bool audx_trace_should_record() {
+    return g_audx_trace_enabled.load(std::memory_order_relaxed) && audx_trace_active();
+}
+
+class AudxTraceScope {
+public:
+    explicit AudxTraceScope(const char *name) : active_(audx_trace_should_record()) {
+        if (active_) {
+            audx_trace_begin(name);
+        }
+    }
+
+    ~AudxTraceScope() {
+        if (active_) {
+            audx_trace_end();
+        }
+    }
+
+    AudxTraceScope(const AudxTraceScope &) = delete;
+    AudxTraceScope &operator=(const AudxTraceScope &) = delete;
+
+private:
+    bool active_;
+};
+
+#define AUDX_TRACE_CONCAT_(a, b) a##b
+#define AUDX_TRACE_CONCAT(a, b) AUDX_TRACE_CONCAT_(a, b)
+#define AUDX_TRACE_SCOPE(name) AudxTraceScope AUDX_TRACE_CONCAT(audx_trace_scope_, __LINE__)(name)
+#define AUDX_TRACE_COUNTER(name, value)                     \
+    do {                                                    \
+        if (audx_trace_should_record()) {                   \
+            audx_trace_counter((name), (int64_t) (value));  \
+        }                                                   \
+    } while (0)
+
+#else
+
+#define AUDX_TRACE_SCOPE(name) ((void) 0)
+#define AUDX_TRACE_COUNTER(name, value) ((void) 0)
+
+#endif // AUDX_TRACING
+
+#endif // AUDX_TRACE_H
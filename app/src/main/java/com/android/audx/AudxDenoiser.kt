@@ -1,9 +1,12 @@
 package com.android.audx
 
+import android.os.Build
+import android.os.Trace
 import android.util.Log
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.withContext
 import java.io.File
+import java.nio.FloatBuffer
 import java.util.concurrent.locks.ReentrantLock
 import kotlin.concurrent.withLock
 
@@ -14,9 +17,22 @@ import kotlin.concurrent.withLock
  *                          Higher values indicate higher likelihood of speech
  * @property isSpeech True if vadProbability exceeds the configured threshold
  * @property samplesProcessed Number of samples processed (should be 480 per channel)
+ * @property bandFeatures With AudxDenoiser.Builder.bandFeatures() enabled, features of
+ *                        the denoised frame: AudxDenoiser.BAND_COUNT band energies
+ *                        (RNNoise's bands, analyzed at 48kHz) followed by as many
+ *                        cepstral coefficients. The array is preallocated and reused
+ *                        for every frame; copy it to keep it. Null when disabled.
+ * @property measuredBandGains With AudxDenoiser.Builder.measuredBandGains() enabled,
+ *                     AudxDenoiser.BAND_COUNT per-band gains measured after the fact as
+ *                     sqrt(output / input) band energy (not RNNoise's internal gains), then
+ *                     the estimated SNR and the noise floor in dB at
+ *                     AudxDenoiser.MEASURED_GAINS_SNR_DB and MEASURED_GAINS_NOISE_FLOOR_DB.
+ *                     Preallocated and reused like bandFeatures. Null when disabled.
  */
 data class DenoiserResult(
-    val vadProbability: Float, val isSpeech: Boolean, val samplesProcessed: Int
+    val vadProbability: Float, val isSpeech: Boolean, val samplesProcessed: Int,
+    val bandFeatures: FloatArray? = null,
+    val measuredBandGains: FloatArray? = null
 )
 
 /**
@@ -33,6 +49,11 @@ data class DenoiserResult(
  * @property processingTimeTotal Total processing time in milliseconds for all frames
  * @property processingTimeAvg Average processing time per frame in milliseconds
  * @property processingTimeLast Processing time for the most recent frame in milliseconds
+ * @property processingLatency Distribution of the denoiser (RNNoise) time per frame
+ * @property endToEndLatency Distribution of the whole per-frame native call, including
+ *                           resampling, array access and result marshalling
+ * @property resampleQuality Current resampling quality; changes over time with
+ *                           Builder.adaptiveResampleQuality()
  */
 data class DenoiserStats(
     val frameProcessed: Int,
@@ -42,7 +63,74 @@ data class DenoiserStats(
     val vadScoreMax: Float,
     val processingTimeTotal: Float,
     val processingTimeAvg: Float,
-    val processingTimeLast: Float
+    val processingTimeLast: Float,
+    val processingLatency: LatencyStats,
+    val endToEndLatency: LatencyStats,
+    val resampleQuality: Int
+)
+
+/**
+ * Per-frame latency distribution
+ *
+ * Percentiles come from a fixed-size log-bucketed histogram and are accurate to
+ * about 3%. Tail percentiles reveal the occasional slow frames that cause audio
+ * dropouts but are hidden by the average. All values are 0 until a frame has been
+ * processed with statistics enabled.
+ *
+ * @property p50 Median frame time in milliseconds
+ * @property p95 95th percentile frame time in milliseconds
+ * @property p99 99th percentile frame time in milliseconds
+ * @property p999 99.9th percentile frame time in milliseconds
+ * @property max Slowest frame in milliseconds (exact)
+ * @property overBudgetFrames Frames that took longer than their 10ms real-time budget
+ */
+data class LatencyStats(
+    val p50: Float,
+    val p95: Float,
+    val p99: Float,
+    val p999: Float,
+    val max: Float,
+    val overBudgetFrames: Int
+)
+
+/**
+ * Aggregated time spent in one stage of the native processing pipeline
+ *
+ * @property frames Number of frames in which the stage ran
+ * @property totalMs Total time in milliseconds
+ * @property avgMs Average time per frame in milliseconds
+ * @property maxMs Slowest frame in milliseconds
+ */
+data class StageTiming(
+    val frames: Int,
+    val totalMs: Float,
+    val avgMs: Float,
+    val maxMs: Float
+)
+
+/**
+ * Per-stage breakdown of the native processing pipeline
+ *
+ * Collected only while enabled with AudxDenoiser.setStageTimingEnabled(). Stages
+ * that did not run (e.g. resampling at 48kHz input) report zero frames.
+ *
+ * @property arrayAccess JNI array pinning and release
+ * @property upsample Resampling the input to 48kHz
+ * @property denoise RNNoise inference and synthesis; for ShortArray audio also the
+ *                   int16/float conversion, which the core library does internally
+ * @property downsample Resampling the output back to the input rate
+ * @property resultMarshalling Construction of the DenoiserResult object
+ * @property convert Sample conversion for FloatArray and ByteArray audio
+ * @property bandAnalysis Band features and measured gains, when enabled
+ */
+data class StageTimings(
+    val arrayAccess: StageTiming,
+    val upsample: StageTiming,
+    val denoise: StageTiming,
+    val downsample: StageTiming,
+    val resultMarshalling: StageTiming,
+    val convert: StageTiming,
+    val bandAnalysis: StageTiming
 )
 
 /**
@@ -50,12 +138,35 @@ data class DenoiserStats(
  */
 typealias ProcessedAudioCallback = (denoisedAudio: ShortArray, result: DenoiserResult) -> Unit
 
+/**
+ * Callback for receiving processed audio as float samples in streaming mode
+ *
+ * Samples are normalized to [-1, 1] and not clipped.
+ */
+typealias ProcessedFloatAudioCallback = (denoisedAudio: FloatArray, result: DenoiserResult) -> Unit
+
+/**
+ * ProcessedFloatAudioCallback delivering each frame as a FloatBuffer
+ *
+ * The buffer wraps the denoiser's reused output array, with position 0 and
+ * limit at the frame size. It is only valid during the callback.
+ */
+typealias ProcessedFloatBufferCallback = (denoisedAudio: FloatBuffer, result: DenoiserResult) -> Unit
+
+/**
+ * Callback for receiving processed 24- or 32-bit PCM in streaming mode, in the
+ * encoding set with AudxDenoiser.Builder.onProcessedPcmAudio()
+ */
+typealias ProcessedPcmAudioCallback = (denoisedAudio: ByteArray, result: DenoiserResult) -> Unit
+
 /**
  * Audio denoiser for real-time processing
  *
  * REQUIREMENTS:
  * - Sample rate: 48kHz (48000 Hz) or specify inputSampleRate for automatic resampling
- * - Audio format: 16-bit signed PCM (Short/int16_t)
+ * - Audio format: 16-bit signed PCM (Short/int16_t), or float PCM in [-1, 1] with
+ *   processChunk(FloatArray) and Builder.onProcessedFloatAudio(), or 24/32-bit PCM with
+ *   processChunk(ByteArray) and Builder.onProcessedPcmAudio()
  * - Frame size: 480 samples (10ms at 48kHz) - varies based on inputSampleRate
  * - Channel: Mono (single-channel) only
  *
@@ -69,13 +180,24 @@ class AudxDenoiser private constructor(
     enableVadOutput: Boolean,
     private val modelPath: String?,
     private val processedAudioCallback: ProcessedAudioCallback?,
-    private val inputSampleRate: Int,
-    private val resampleQuality: Int
+    private var inputSampleRate: Int,
+    private val resampleQuality: Int,
+    private val pipelined: Boolean,
+    adaptiveQuality: IntRange? = null,
+    private val processedFloatAudioCallback: ProcessedFloatAudioCallback? = null,
+    private val processedPcmAudioCallback: ProcessedPcmAudioCallback? = null,
+    private val pcmEncoding: PcmEncoding = PcmEncoding.PCM_32BIT,
+    bandFeatures: Boolean = false,
+    measuredBandGains: Boolean = false,
+    pool: AudxDenoiserPool? = null
 ) : AutoCloseable {
 
     companion object {
         private const val TAG = "Denoiser"
 
+        // AUDX_ERROR_INVALID from audx/common.h
+        private const val ERROR_INVALID = -1
+
         init {
             try {
                 System.loadLibrary("audx")
@@ -85,12 +207,45 @@ class AudxDenoiser private constructor(
             }
         }
 
+        @Volatile
+        private var tracingEnabled = false
+
+        /**
+         * Enable or disable trace markers
+         *
+         * When enabled, the native pipeline emits ATrace sections for each frame
+         * and stage (processNative, frame, upsample, denoise, downsample, array
+         * access, marshalling) plus counters for the VAD probability and the
+         * number of samples queued in processChunk(), so denoiser stalls can be
+         * correlated with scheduler and GC activity in Perfetto or systrace.
+         *
+         * Events are only recorded while a system trace is being captured. Applies
+         * to all denoiser instances. Disabled by default.
+         */
+        @JvmStatic
+        fun setTracingEnabled(enabled: Boolean) {
+            tracingEnabled = enabled
+            setTracingEnabledNative(enabled)
+        }
+
+        @JvmStatic
+        private external fun setTracingEnabledNative(enabled: Boolean)
+
         // Resampler quality constants
         const val RESAMPLER_QUALITY_MAX = 10
         const val RESAMPLER_QUALITY_MIN = 0
         const val RESAMPLER_QUALITY_DEFAULT = 4
         const val RESAMPLER_QUALITY_VOIP = 3
 
+        // DenoiserResult.bandFeatures layout: band energies, then cepstrum
+        const val BAND_COUNT = 22
+        const val BAND_FEATURES_SIZE = 2 * BAND_COUNT
+
+        // DenoiserResult.measuredBandGains layout: per-band gains, then SNR and noise floor
+        const val MEASURED_GAINS_SNR_DB = BAND_COUNT
+        const val MEASURED_GAINS_NOISE_FLOOR_DB = BAND_COUNT + 1
+        const val MEASURED_GAINS_SIZE = BAND_COUNT + 2
+
         // Audio format constants from native library (single source of truth)
 
         /**
@@ -161,23 +316,41 @@ class AudxDenoiser private constructor(
     }
 
     private var nativeHandle: Long = 0
+    private var ownerPool: AudxDenoiserPool? = null  // Non-null if nativeHandle came from a pool
 
     // Calculate frame size based on input sample rate (10ms chunks)
-    private val inputFrameSize: Int
+    private var inputFrameSize: Int
 
     // Streaming mode: buffer for accumulating samples until we have a complete frame
     private var streamBuffer: ShortArray
     private var bufferSize = 0  // Current number of samples in buffer
+    private var floatStreamBuffer = FloatArray(0)  // Buffer for processChunk(FloatArray)
+    private var bufferHoldsFloat = false  // The buffered samples are in floatStreamBuffer
+    private var pcmStreamBuffer = ByteArray(0)  // Buffer for processChunk(ByteArray)
+    private var pipelineHoldsAudio = false  // Pipelined mode: a real frame is still in flight
     private val bufferLock = ReentrantLock()
 
     private var frameBufferCache: ShortArray? = null
     private var outBufferCache: ShortArray? = null
+    private var floatOutBufferCache: FloatArray? = null
+    private var floatFrameBufferCache: FloatArray? = null
+    private var pcmFrameBufferCache: ByteArray? = null
+    private var pcmOutBufferCache: ByteArray? = null
+    private val bandFeatureBuffer = if (bandFeatures) FloatArray(BAND_FEATURES_SIZE) else null
+    private val bandGainBuffer = if (measuredBandGains) FloatArray(MEASURED_GAINS_SIZE) else null
     private val audioDispatcher = Dispatchers.Default.limitedParallelism(1)
 
     enum class ModelPreset(val value: Int) {
         EMBEDDED(0), CUSTOM(1)
     }
 
+    /** Integer PCM encodings for processChunk(ByteArray), little-endian */
+    enum class PcmEncoding(val value: Int, val bytesPerSample: Int) {
+        PCM_24BIT_PACKED(1, 3),  // AudioFormat.ENCODING_PCM_24BIT_PACKED
+        PCM_24BIT_IN_32(2, 4),   // Low 24 bits of each 32-bit word, sign-extended
+        PCM_32BIT(3, 4)          // AudioFormat.ENCODING_PCM_32BIT
+    }
+
     init {
         require(vadThreshold in 0.0f..1.0f) {
             "vadThreshold must be between 0.0 and 1.0"
@@ -188,6 +361,27 @@ class AudxDenoiser private constructor(
         require(resampleQuality in RESAMPLER_QUALITY_MIN..RESAMPLER_QUALITY_MAX) {
             "resampleQuality must be between $RESAMPLER_QUALITY_MIN and $RESAMPLER_QUALITY_MAX"
         }
+        if (adaptiveQuality != null) {
+            require(
+                adaptiveQuality.first >= RESAMPLER_QUALITY_MIN &&
+                        adaptiveQuality.last <= RESAMPLER_QUALITY_MAX &&
+                        !adaptiveQuality.isEmpty()
+            ) {
+                "Adaptive quality range must be within $RESAMPLER_QUALITY_MIN..$RESAMPLER_QUALITY_MAX"
+            }
+        }
+        require(
+            listOfNotNull(processedAudioCallback, processedFloatAudioCallback, processedPcmAudioCallback)
+                .size <= 1
+        ) {
+            "Set only one of onProcessedAudio, onProcessedFloatAudio and onProcessedPcmAudio"
+        }
+        if (processedFloatAudioCallback != null || processedPcmAudioCallback != null) {
+            require(!pipelined) { "Float and PCM output are not available in pipelined mode" }
+        }
+        require(!((bandFeatures || measuredBandGains) && pipelined)) {
+            "Band features and gains are not available in pipelined mode"
+        }
         if (modelPreset == ModelPreset.CUSTOM) {
             requireNotNull(modelPath) {
                 "modelPath is required when using CUSTOM model preset"
@@ -201,19 +395,53 @@ class AudxDenoiser private constructor(
         inputFrameSize = (inputSampleRate * 10 / 1000) * CHANNELS
         streamBuffer = ShortArray(inputFrameSize * 4)  // Initial capacity: 4 frames
 
-        nativeHandle = createNative(
-            modelPreset.value, modelPath, vadThreshold, enableVadOutput,
-            inputSampleRate, resampleQuality
-        )
+        val pooledHandle = pool?.acquireHandle() ?: 0L
+        if (pooledHandle != 0L) {
+            nativeHandle = pooledHandle
+            ownerPool = pool
+        } else {
+            // Not pooled, or the pool is exhausted
+            nativeHandle = createNative(
+                modelPreset.value, modelPath, vadThreshold, enableVadOutput,
+                inputSampleRate, resampleQuality, pipelined
+            )
+        }
 
         if (nativeHandle == 0L) {
             throw RuntimeException("Failed to create native denoiser")
         }
 
+        if (adaptiveQuality != null) {
+            val ret = setAdaptiveQualityNative(nativeHandle, adaptiveQuality.first, adaptiveQuality.last)
+            if (ret != 0) {
+                destroy()
+                throw RuntimeException("Failed to enable adaptive resampling quality: $ret")
+            }
+        }
+
+        if (bandFeatures) {
+            val ret = setBandFeaturesNative(nativeHandle, true)
+            if (ret != 0) {
+                destroy()
+                throw RuntimeException("Failed to enable band features: $ret")
+            }
+        }
+
+        if (measuredBandGains) {
+            val ret = setBandGainsNative(nativeHandle, true)
+            if (ret != 0) {
+                destroy()
+                throw RuntimeException("Failed to enable band gains: $ret")
+            }
+        }
+
         val needsResampling = inputSampleRate != SAMPLE_RATE
         Log.i(
             TAG, "Denoiser initialized (inputRate=$inputSampleRate, preset=$modelPreset, " +
-                    "vad=$vadThreshold, needsResampling=$needsResampling, quality=$resampleQuality)"
+                    "vad=$vadThreshold, needsResampling=$needsResampling, quality=$resampleQuality, " +
+                    "adaptiveQuality=$adaptiveQuality, bandFeatures=$bandFeatures, " +
+                    "measuredBandGains=$measuredBandGains, " +
+                    "pipelined=$pipelined, pooled=${ownerPool != null})"
         )
     }
 
@@ -250,8 +478,16 @@ class AudxDenoiser private constructor(
         private var vadThreshold: Float = 0.5f
         private var isCollectStatistics: Boolean = false
         private var processedAudioCallback: ProcessedAudioCallback? = null
+        private var processedFloatAudioCallback: ProcessedFloatAudioCallback? = null
+        private var processedFloatBufferCallback: ProcessedFloatBufferCallback? = null
+        private var processedPcmAudioCallback: ProcessedPcmAudioCallback? = null
+        private var pcmEncoding: PcmEncoding = PcmEncoding.PCM_32BIT
         private var inputSampleRate: Int = SAMPLE_RATE  // Default to 48kHz (no resampling)
         private var resampleQuality: Int = RESAMPLER_QUALITY_DEFAULT
+        private var pipelined: Boolean = false
+        private var adaptiveQuality: IntRange? = null
+        private var bandFeatures: Boolean = false
+        private var measuredBandGains: Boolean = false
 
         /**
          * Set model preset (EMBEDDED or CUSTOM)
@@ -291,6 +527,19 @@ class AudxDenoiser private constructor(
          */
         fun resampleQuality(value: Int) = apply { this.resampleQuality = value }
 
+        /**
+         * Let the denoiser pick its resampling quality at runtime from measured
+         * CPU headroom, between [minQuality] and [maxQuality]. It starts at
+         * resampleQuality (clamped to the range), steps down when frames use more
+         * than half of their 10ms budget and steps back up after a few seconds
+         * with ample headroom. The current level is DenoiserStats.resampleQuality.
+         * Only used if inputSampleRate != 48kHz.
+         */
+        fun adaptiveResampleQuality(
+            minQuality: Int = RESAMPLER_QUALITY_MIN,
+            maxQuality: Int = RESAMPLER_QUALITY_MAX
+        ) = apply { this.adaptiveQuality = minQuality..maxQuality }
+
         /**
          * Set callback for streaming mode. When set, use processChunk() to feed audio.
          * The callback receives denoised audio in the same format as input.
@@ -301,17 +550,174 @@ class AudxDenoiser private constructor(
             this.processedAudioCallback = callback
         }
 
+        /**
+         * Set a float callback for streaming mode, instead of onProcessedAudio().
+         * The callback receives the denoiser output before int16 conversion,
+         * normalized to [-1, 1] and not clipped, at the input sample rate.
+         * Not available in pipelined mode.
+         *
+         * @param callback Function that receives (denoisedAudio, result) for each processed frame
+         */
+        fun onProcessedFloatAudio(callback: ProcessedFloatAudioCallback?) = apply {
+            this.processedFloatAudioCallback = callback
+        }
+
+        /**
+         * onProcessedFloatAudio() for consumers that take a FloatBuffer. Frames
+         * arrive in a reused buffer wrapping the output array, so no copy or
+         * extra allocation is made per frame.
+         *
+         * @param callback Function that receives (denoisedAudio, result) for each processed frame
+         */
+        fun onProcessedFloatBuffer(callback: ProcessedFloatBufferCallback?) = apply {
+            this.processedFloatBufferCallback = callback
+        }
+
+        /**
+         * Set a callback for 24- or 32-bit integer PCM, fed with
+         * processChunk(ByteArray), instead of onProcessedAudio(). Audio stays
+         * at full precision: it is converted to float natively and back to
+         * [encoding] for the callback. Not available in pipelined mode.
+         *
+         * @param encoding Encoding of both the input chunks and the callback audio
+         * @param callback Function that receives (denoisedAudio, result) for each processed frame
+         */
+        fun onProcessedPcmAudio(encoding: PcmEncoding, callback: ProcessedPcmAudioCallback?) = apply {
+            this.pcmEncoding = encoding
+            this.processedPcmAudioCallback = callback
+        }
+
+        /**
+         * Attach per-frame features of the denoised audio to every
+         * DenoiserResult (DenoiserResult.bandFeatures), e.g. as ASR front-end
+         * input: the energies of RNNoise's 22 bands and their cepstrum, computed
+         * at 48kHz on the same 20ms window RNNoise uses. Costs one FFT per frame.
+         * Not available in pipelined mode.
+         * @param value Enable band features (default: false)
+         */
+        fun bandFeatures(value: Boolean) = apply { this.bandFeatures = value }
+
+        /**
+         * Attach measured per-band gains to every DenoiserResult
+         * (DenoiserResult.measuredBandGains), e.g. for monitoring or to steer an
+         * encoder: for each of RNNoise's 22 bands, sqrt(output / input) of the
+         * band energy, plus the frame's estimated SNR and the tracked noise
+         * floor. RNNoise does not expose the gains it applies, so these are
+         * energy ratios computed after denoising, at the cost of one or two
+         * FFTs per frame (one when bandFeatures() is also on).
+         * Not available in pipelined mode.
+         * @param value Enable measured band gains (default: false)
+         */
+        fun measuredBandGains(value: Boolean) = apply { this.measuredBandGains = value }
+
+        /**
+         * Run inference on a dedicated native thread, overlapping it with
+         * resampling of the next frame. Adds one frame (10ms) of latency: each
+         * callback carries the previous frame, and the first one is silence.
+         * flush() drains the last frame.
+         * @param value Enable pipelined mode (default: false)
+         */
+        fun pipelined(value: Boolean) = apply { this.pipelined = value }
+
+        /** Whether pipelined mode is enabled on this builder */
+        internal fun isPipelined(): Boolean = pipelined
+
+        internal fun isAdaptiveQuality(): Boolean = adaptiveQuality != null
+
+        /** Input sample rate configured on this builder */
+        internal fun sampleRate(): Int = inputSampleRate
+
+        /** Samples per 10ms frame at the configured input sample rate */
+        internal fun frameSamples(): Int = (inputSampleRate * 10 / 1000) * CHANNELS
+
         fun build(): AudxDenoiser {
+            require(processedFloatAudioCallback == null || processedFloatBufferCallback == null) {
+                "Set only one of onProcessedFloatAudio and onProcessedFloatBuffer"
+            }
+            // One adapter per denoiser, so each reuses its own buffer
+            val floatCallback = processedFloatAudioCallback
+                ?: processedFloatBufferCallback?.let { floatBufferAdapter(it) }
+            return build(null, processedAudioCallback, floatCallback, pcmEncoding, processedPcmAudioCallback)
+        }
+
+        /**
+         * Create a pool of [size] ready-to-use denoisers with this configuration
+         *
+         * The denoisers are created up front; AudxDenoiserPool.acquire() then
+         * hands one out in microseconds. Later changes to this builder do not
+         * affect the pool.
+         *
+         * Output callbacks are chosen per denoiser with AudxDenoiserPool.acquire(),
+         * acquireFloat() or acquirePcm(), not on this builder.
+         *
+         * @throws IllegalArgumentException if size is not positive, pipelined mode is
+         *         enabled or an output callback is set
+         * @throws RuntimeException if native initialization fails
+         */
+        fun buildPool(size: Int): AudxDenoiserPool {
+            require(size > 0) { "Pool size must be positive" }
+            require(!pipelined) { "Pipelined denoisers cannot be pooled" }
+            require(
+                processedAudioCallback == null && processedFloatAudioCallback == null &&
+                    processedFloatBufferCallback == null && processedPcmAudioCallback == null
+            ) {
+                "Pass the output callback to AudxDenoiserPool.acquire(), acquireFloat() or acquirePcm()"
+            }
+            return AudxDenoiserPool(
+                copy(), size, modelPreset.value, modelPath, vadThreshold,
+                isCollectStatistics, inputSampleRate, resampleQuality
+            )
+        }
+
+        internal fun build(
+            pool: AudxDenoiserPool?,
+            callback: ProcessedAudioCallback?,
+            floatCallback: ProcessedFloatAudioCallback? = null,
+            pcmEncoding: PcmEncoding = this.pcmEncoding,
+            pcmCallback: ProcessedPcmAudioCallback? = null
+        ): AudxDenoiser {
             return AudxDenoiser(
                 modelPreset = modelPreset,
                 modelPath = modelPath,
                 vadThreshold = vadThreshold,
                 enableVadOutput = isCollectStatistics,
-                processedAudioCallback = processedAudioCallback,
+                processedAudioCallback = callback,
                 inputSampleRate = inputSampleRate,
-                resampleQuality = resampleQuality
+                resampleQuality = resampleQuality,
+                pipelined = pipelined,
+                adaptiveQuality = adaptiveQuality,
+                processedFloatAudioCallback = floatCallback,
+                processedPcmAudioCallback = pcmCallback,
+                pcmEncoding = pcmEncoding,
+                bandFeatures = bandFeatures,
+                measuredBandGains = measuredBandGains,
+                pool = pool
             )
         }
+
+        private fun floatBufferAdapter(callback: ProcessedFloatBufferCallback): ProcessedFloatAudioCallback {
+            var wrapper: FloatBuffer? = null
+            return { audio, result ->
+                // Streaming reuses one output array; flush() hands out a trimmed copy
+                val buffer = wrapper?.takeIf { it.array() === audio }
+                    ?: FloatBuffer.wrap(audio).also { wrapper = it }
+                buffer.clear()
+                callback(buffer, result)
+            }
+        }
+
+        /** Configuration only, without callbacks */
+        internal fun copy(): Builder = Builder().also {
+            it.modelPreset = modelPreset
+            it.modelPath = modelPath
+            it.vadThreshold = vadThreshold
+            it.isCollectStatistics = isCollectStatistics
+            it.inputSampleRate = inputSampleRate
+            it.resampleQuality = resampleQuality
+            it.adaptiveQuality = adaptiveQuality
+            it.bandFeatures = bandFeatures
+            it.measuredBandGains = measuredBandGains
+        }
     }
 
 
@@ -319,6 +725,7 @@ class AudxDenoiser private constructor(
      * Process audio chunk of any size for real-time streaming.
      * Internally buffers samples until complete frames are available.
      * Processed audio is delivered via the callback set in Builder.onProcessedAudio()
+     * or Builder.onProcessedFloatAudio()
      *
      * IMPORTANT: Input audio must match the inputSampleRate specified in Builder,
      * 16-bit PCM mono format. If inputSampleRate != 48kHz, resampling is handled automatically.
@@ -333,12 +740,17 @@ class AudxDenoiser private constructor(
      */
     suspend fun processChunk(input: ShortArray) = withContext(audioDispatcher) {
         check(nativeHandle != 0L) { "Denoiser has been destroyed" }
-        requireNotNull(processedAudioCallback) {
-            "processChunk requires a callback. Use Builder.onProcessedAudio() to set one."
+        require(processedAudioCallback != null || processedFloatAudioCallback != null) {
+            "processChunk requires a callback. Use Builder.onProcessedAudio() or onProcessedFloatAudio() to set one."
         }
         require(input.isNotEmpty()) { "Input audio cannot be empty" }
 
         bufferLock.withLock {
+            check(bufferSize == 0 || !bufferHoldsFloat) {
+                "flush() before switching between FloatArray and ShortArray input"
+            }
+            bufferHoldsFloat = false
+
             // Ensure capacity
             val requiredCapacity = bufferSize + input.size
             if (requiredCapacity > streamBuffer.size) {
@@ -350,14 +762,13 @@ class AudxDenoiser private constructor(
             // Append input
             System.arraycopy(input, 0, streamBuffer, bufferSize, input.size)
             bufferSize += input.size
+            traceQueueDepth(bufferSize)
 
             // Preallocate once (reuse!)
             val frameBuffer = frameBufferCache ?: ShortArray(inputFrameSize).also {
                 frameBufferCache = it
             }
-            val outBuffer = outBufferCache ?: ShortArray(inputFrameSize).also {
-                outBufferCache = it
-            }
+            val floatCallback = processedFloatAudioCallback
 
             // Process all complete frames
             while (bufferSize >= inputFrameSize) {
@@ -366,11 +777,28 @@ class AudxDenoiser private constructor(
                 System.arraycopy(streamBuffer, 0, frameBuffer, 0, inputFrameSize)
 
                 // Native processing
-                val status = processNative(nativeHandle, frameBuffer, outBuffer)
-
-                if (status != null) {
-                    processedAudioCallback.invoke(outBuffer, status)
+                val status = if (floatCallback != null) {
+                    val floatOutBuffer = floatOutBufferCache ?: FloatArray(inputFrameSize).also {
+                        floatOutBufferCache = it
+                    }
+                    processFloatNative(
+                        nativeHandle, frameBuffer, floatOutBuffer, bandFeatureBuffer, bandGainBuffer
+                    )?.also {
+                        floatCallback.invoke(floatOutBuffer, it)
+                    }
                 } else {
+                    val outBuffer = outBufferCache ?: ShortArray(inputFrameSize).also {
+                        outBufferCache = it
+                    }
+                    processNative(
+                        nativeHandle, frameBuffer, outBuffer, bandFeatureBuffer, bandGainBuffer
+                    )?.also {
+                        processedAudioCallback?.invoke(outBuffer, it)
+                    }
+                }
+                pipelineHoldsAudio = pipelined
+
+                if (status == null) {
                     Log.w(TAG, "Native processing returned null for chunk")
                 }
 
@@ -381,45 +809,277 @@ class AudxDenoiser private constructor(
                 }
                 bufferSize = remaining
             }
+            traceQueueDepth(bufferSize)
+        }
+    }
+
+    /**
+     * Process float audio, e.g. captured with AudioFormat.ENCODING_PCM_FLOAT
+     *
+     * Samples are normalized to [-1, 1]. They are resampled and denoised in
+     * float without a round trip through 16-bit, and delivered via the callback
+     * set in Builder.onProcessedFloatAudio(). Buffering works as in
+     * processChunk(ShortArray); call flush() before switching between the two.
+     *
+     * @param input Audio samples at the specified inputSampleRate (any size)
+     * @throws IllegalArgumentException if no float callback was set or the chunk is empty
+     * @throws IllegalStateException if ShortArray samples are still buffered
+     */
+    suspend fun processChunk(input: FloatArray) = withContext(audioDispatcher) {
+        check(nativeHandle != 0L) { "Denoiser has been destroyed" }
+        val floatCallback = requireNotNull(processedFloatAudioCallback) {
+            "Float input requires a callback set with Builder.onProcessedFloatAudio()."
+        }
+        require(input.isNotEmpty()) { "Input audio cannot be empty" }
+
+        bufferLock.withLock {
+            check(bufferSize == 0 || bufferHoldsFloat) {
+                "flush() before switching between ShortArray and FloatArray input"
+            }
+            bufferHoldsFloat = true
+
+            val requiredCapacity = bufferSize + input.size
+            if (requiredCapacity > floatStreamBuffer.size) {
+                val newCapacity = maxOf(floatStreamBuffer.size * 2, requiredCapacity, inputFrameSize * 4)
+                floatStreamBuffer = floatStreamBuffer.copyOf(newCapacity)
+            }
+            System.arraycopy(input, 0, floatStreamBuffer, bufferSize, input.size)
+            bufferSize += input.size
+            traceQueueDepth(bufferSize)
+
+            val frameBuffer = floatFrameBufferCache ?: FloatArray(inputFrameSize).also {
+                floatFrameBufferCache = it
+            }
+            val outBuffer = floatOutBufferCache ?: FloatArray(inputFrameSize).also {
+                floatOutBufferCache = it
+            }
+
+            while (bufferSize >= inputFrameSize) {
+                System.arraycopy(floatStreamBuffer, 0, frameBuffer, 0, inputFrameSize)
+
+                val status = processFloatInputNative(
+                    nativeHandle, frameBuffer, outBuffer, bandFeatureBuffer, bandGainBuffer
+                )
+                if (status != null) {
+                    floatCallback.invoke(outBuffer, status)
+                } else {
+                    Log.w(TAG, "Native processing returned null for chunk")
+                }
+
+                val remaining = bufferSize - inputFrameSize
+                if (remaining > 0) {
+                    System.arraycopy(floatStreamBuffer, inputFrameSize, floatStreamBuffer, 0, remaining)
+                }
+                bufferSize = remaining
+            }
+            traceQueueDepth(bufferSize)
         }
     }
 
+    /**
+     * Process 24- or 32-bit integer PCM in the encoding set with
+     * Builder.onProcessedPcmAudio(), e.g. read from an AudioRecord with
+     * AudioFormat.ENCODING_PCM_24BIT_PACKED or ENCODING_PCM_32BIT
+     *
+     * Samples are converted to float with SIMD kernels, denoised without a
+     * round trip through 16-bit and delivered in the same encoding. Buffering
+     * works as in processChunk(ShortArray).
+     *
+     * @param input Little-endian samples at the specified inputSampleRate; any
+     *        whole number of samples
+     * @throws IllegalArgumentException if no PCM callback was set or the chunk
+     *         is empty or holds a partial sample
+     */
+    suspend fun processChunk(input: ByteArray) = withContext(audioDispatcher) {
+        check(nativeHandle != 0L) { "Denoiser has been destroyed" }
+        val pcmCallback = requireNotNull(processedPcmAudioCallback) {
+            "ByteArray input requires a callback set with Builder.onProcessedPcmAudio()."
+        }
+        val bytesPerSample = pcmEncoding.bytesPerSample
+        require(input.isNotEmpty() && input.size % bytesPerSample == 0) {
+            "Input must hold whole $pcmEncoding samples"
+        }
+
+        bufferLock.withLock {
+            val requiredCapacity = (bufferSize * bytesPerSample) + input.size
+            if (requiredCapacity > pcmStreamBuffer.size) {
+                val newCapacity = maxOf(
+                    pcmStreamBuffer.size * 2, requiredCapacity, inputFrameSize * bytesPerSample * 4
+                )
+                pcmStreamBuffer = pcmStreamBuffer.copyOf(newCapacity)
+            }
+            System.arraycopy(input, 0, pcmStreamBuffer, bufferSize * bytesPerSample, input.size)
+            bufferSize += input.size / bytesPerSample
+            traceQueueDepth(bufferSize)
+
+            val frameBytes = inputFrameSize * bytesPerSample
+            val frameBuffer = pcmFrameBufferCache ?: ByteArray(frameBytes).also {
+                pcmFrameBufferCache = it
+            }
+            val outBuffer = pcmOutBufferCache ?: ByteArray(frameBytes).also {
+                pcmOutBufferCache = it
+            }
+
+            while (bufferSize >= inputFrameSize) {
+                System.arraycopy(pcmStreamBuffer, 0, frameBuffer, 0, frameBytes)
+
+                val status = processPcmNative(
+                    nativeHandle, pcmEncoding.value, frameBuffer, outBuffer,
+                    bandFeatureBuffer, bandGainBuffer
+                )
+                if (status != null) {
+                    pcmCallback.invoke(outBuffer, status)
+                } else {
+                    Log.w(TAG, "Native processing returned null for chunk")
+                }
+
+                val remaining = bufferSize - inputFrameSize
+                if (remaining > 0) {
+                    System.arraycopy(
+                        pcmStreamBuffer, frameBytes, pcmStreamBuffer, 0, remaining * bytesPerSample
+                    )
+                }
+                bufferSize = remaining
+            }
+            traceQueueDepth(bufferSize)
+        }
+    }
+
+    private fun traceQueueDepth(samples: Int) {
+        // Trace.setCounter is API 29
+        if (tracingEnabled && Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q && Trace.isEnabled()) {
+            Trace.setCounter("audx.queue_depth", samples.toLong())
+        }
+    }
+
+    /**
+     * Denoise whole frames in one native call, bypassing the streaming buffer
+     *
+     * Used by AudxOfflineDenoiser. Must not be mixed with processChunk() on the
+     * same instance. input and output must hold frames * frame size samples from
+     * their offsets.
+     *
+     * @throws IllegalStateException if denoiser has been destroyed or processing fails
+     */
+    internal fun processFrames(
+        input: ShortArray, inputOffset: Int, output: ShortArray, outputOffset: Int, frames: Int
+    ) {
+        check(nativeHandle != 0L) { "Denoiser has been destroyed" }
+        check(!pipelined) { "processFrames is not available in pipelined mode" }
+        val ret = processFramesNative(nativeHandle, input, inputOffset, output, outputOffset, frames)
+        check(ret == 0) { "Native batch processing failed: $ret" }
+    }
+
     /**
      * Flush any remaining buffered samples by processing them as a partial frame.
+     * In pipelined mode this also drains the frame still in flight.
      * Call this when stopping recording to ensure all audio is processed.
      * Only needed in streaming mode (when using processChunk).
      */
     suspend fun flush() = withContext(audioDispatcher) {
         check(nativeHandle != 0L) { "Denoiser has been destroyed" }
-
-        if (processedAudioCallback == null) return@withContext
-
         bufferLock.withLock {
-            if (bufferSize == 0) return@withContext
-
-            // Pad remaining samples to complete frame with zeros
-            val remaining = bufferSize
-            val paddingNeeded = inputFrameSize - remaining
+            flushBuffered()
+        }
+    }
 
-            // Create frame with padding
-            val frame = ShortArray(inputFrameSize)
-            System.arraycopy(streamBuffer, 0, frame, 0, remaining)
-            // Remaining elements are already zero-initialized in ShortArray
+    /** Body of flush(). Caller holds bufferLock. */
+    private fun flushBuffered() {
+        if (processedAudioCallback == null && processedFloatAudioCallback == null &&
+            processedPcmAudioCallback == null
+        ) return
 
-            // Process the final padded frame
-            val output = ShortArray(inputFrameSize)
-            val result = processNative(nativeHandle, frame, output)
+        if (bufferSize == 0) {
+            if (pipelineHoldsAudio) drainPipeline(inputFrameSize)
+            return
+        }
 
-            // Deliver only the non-padded portion via callback
+        // Pad remaining samples to complete frame with zeros
+        val remaining = bufferSize
+        val paddingNeeded = inputFrameSize - remaining
+
+        val pcmCallback = processedPcmAudioCallback
+        if (pcmCallback != null) {
+            val bytesPerSample = pcmEncoding.bytesPerSample
+            val frame = pcmStreamBuffer.copyOf(inputFrameSize * bytesPerSample)
+            frame.fill(0, remaining * bytesPerSample)
+            val output = ByteArray(frame.size)
+            val result = processPcmNative(
+                nativeHandle, pcmEncoding.value, frame, output, bandFeatureBuffer, bandGainBuffer
+            )
             if (result != null) {
-                val actualOutput = output.copyOfRange(0, remaining)
-                processedAudioCallback.invoke(actualOutput, result)
+                pcmCallback.invoke(output.copyOfRange(0, remaining * bytesPerSample), result)
             }
+            bufferSize = 0
+            Log.d(TAG, "Flushed $remaining remaining samples (padded with $paddingNeeded zeros)")
+            return
+        }
 
-            // Clear buffer
+        val floatCallback = processedFloatAudioCallback
+        if (floatCallback != null && bufferHoldsFloat) {
+            val frame = floatStreamBuffer.copyOf(inputFrameSize)
+            frame.fill(0.0f, remaining)
+            val output = FloatArray(inputFrameSize)
+            val result =
+                processFloatInputNative(nativeHandle, frame, output, bandFeatureBuffer, bandGainBuffer)
+            if (result != null) {
+                floatCallback.invoke(output.copyOfRange(0, remaining), result)
+            }
             bufferSize = 0
+            Log.d(TAG, "Flushed $remaining remaining samples (padded with $paddingNeeded zeros)")
+            return
+        }
+
+        // Create frame with padding
+        val frame = ShortArray(inputFrameSize)
+        System.arraycopy(streamBuffer, 0, frame, 0, remaining)
+        // Remaining elements are already zero-initialized in ShortArray
 
+        if (floatCallback != null) {
+            val output = FloatArray(inputFrameSize)
+            val result = processFloatNative(nativeHandle, frame, output, bandFeatureBuffer, bandGainBuffer)
+            if (result != null) {
+                floatCallback.invoke(output.copyOfRange(0, remaining), result)
+            }
+            bufferSize = 0
             Log.d(TAG, "Flushed $remaining remaining samples (padded with $paddingNeeded zeros)")
+            return
+        }
+
+        // Process the final padded frame
+        val output = ShortArray(inputFrameSize)
+        val result = processNative(nativeHandle, frame, output, bandFeatureBuffer, bandGainBuffer)
+
+        if (pipelined) {
+            // The output is the previous, complete frame; the padded one is drained below
+            if (result != null) {
+                processedAudioCallback?.invoke(output, result)
+            }
+            drainPipeline(remaining)
+        } else if (result != null) {
+            // Deliver only the non-padded portion via callback
+            val actualOutput = output.copyOfRange(0, remaining)
+            processedAudioCallback?.invoke(actualOutput, result)
+        }
+
+        // Clear buffer
+        bufferSize = 0
+
+        Log.d(TAG, "Flushed $remaining remaining samples (padded with $paddingNeeded zeros)")
+    }
+
+    /**
+     * Push a silent frame through the pipeline and deliver the first
+     * [samples] of the frame it returns. Caller holds bufferLock.
+     */
+    private fun drainPipeline(samples: Int) {
+        val output = ShortArray(inputFrameSize)
+        val result = processNative(
+            nativeHandle, ShortArray(inputFrameSize), output, bandFeatureBuffer, bandGainBuffer
+        )
+        pipelineHoldsAudio = false
+        if (result != null) {
+            processedAudioCallback?.invoke(output.copyOfRange(0, samples), result)
         }
     }
 
@@ -437,7 +1097,9 @@ class AudxDenoiser private constructor(
      * VAD score statistics, and processing time metrics. Statistics accumulate over
      * the lifetime of this denoiser instance unless explicitly reset with resetStats().
      *
-     * Thread-safe: Can be called from any thread.
+     * Thread-safe: Can be called from any thread. The snapshot is published by the
+     * audio thread after each frame and read lock-free, so polling never blocks
+     * processing and always returns values from the same frame.
      *
      * @return Current statistics snapshot, or null if stats retrieval fails
      * @throws IllegalStateException if denoiser has been destroyed
@@ -461,7 +1123,9 @@ class AudxDenoiser private constructor(
      * val stats = denoiser.getStats()  // Get stats for this session
      * ```
      *
-     * Thread-safe: Can be called from any thread.
+     * Thread-safe: Can be called from any thread. getStats() reflects the reset
+     * immediately; the native counters are cleared by the audio thread before
+     * its next frame, so a reset never races a frame in progress.
      *
      * @throws IllegalStateException if denoiser has been destroyed
      */
@@ -470,6 +1134,141 @@ class AudxDenoiser private constructor(
         resetStatsNative(nativeHandle)
     }
 
+    /**
+     * Enable or disable the per-stage timing breakdown
+     *
+     * Disabled by default. While disabled the timers cost a single flag check per
+     * frame; while enabled each stage adds one clock read. Takes effect at the next
+     * frame. Timings are cleared by resetStats().
+     *
+     * Thread-safe: Can be called from any thread.
+     *
+     * @throws IllegalStateException if denoiser has been destroyed
+     */
+    fun setStageTimingEnabled(enabled: Boolean) {
+        check(nativeHandle != 0L) { "Denoiser has been destroyed" }
+        setStageTimingEnabledNative(nativeHandle, enabled)
+    }
+
+    /**
+     * Get the per-stage timing breakdown
+     *
+     * Shows where per-frame time goes: JNI array access, resampling, denoising or
+     * result marshalling. Only frames processed while stage timing was enabled
+     * are counted.
+     *
+     * Thread-safe: Can be called from any thread.
+     *
+     * @return Current timings, or null if retrieval fails
+     * @throws IllegalStateException if denoiser has been destroyed
+     */
+    fun getStageTimings(): StageTimings? {
+        check(nativeHandle != 0L) { "Denoiser has been destroyed" }
+        return getStageTimingsNative(nativeHandle)
+    }
+
+    /**
+     * Reset the denoiser to its just-built state, e.g. between utterances or calls
+     *
+     * Re-initializes the RNNoise state in place, clears the resampler memories,
+     * discards buffered samples and zeroes statistics. Nothing is freed or
+     * allocated, so one instance can be reused indefinitely instead of destroying
+     * and rebuilding it. In pipelined mode the frame in flight is dropped and the
+     * next callback is silence again.
+     *
+     * @throws IllegalStateException if denoiser has been destroyed
+     */
+    suspend fun reset() = withContext(audioDispatcher) {
+        check(nativeHandle != 0L) { "Denoiser has been destroyed" }
+        bufferLock.withLock {
+            resetNative(nativeHandle)
+            bufferSize = 0
+            pipelineHoldsAudio = false
+        }
+    }
+
+    /**
+     * Change the input sample rate without rebuilding the denoiser
+     *
+     * For capture paths that switch rate mid-stream, such as a Bluetooth headset
+     * moving between narrowband (8 kHz) and wideband (16 kHz) SCO. The RNNoise
+     * state is kept, so there is no gap or re-convergence; the resamplers are
+     * retuned in place and nothing is reallocated. Samples buffered by
+     * processChunk() are at the old rate and are flushed first, as with flush().
+     * Chunks passed after this call, and the callback's output, are at the new
+     * rate.
+     *
+     * @param rate New input rate, from 8000 Hz up to 48000 Hz or the rate the
+     *        denoiser was built with, whichever is higher
+     * @throws IllegalArgumentException if the rate is out of range
+     * @throws IllegalStateException if denoiser has been destroyed
+     */
+    suspend fun setInputSampleRate(rate: Int) = withContext(audioDispatcher) {
+        check(nativeHandle != 0L) { "Denoiser has been destroyed" }
+        bufferLock.withLock {
+            if (rate == inputSampleRate) return@withContext
+            flushBuffered()
+
+            val ret = setInputSampleRateNative(nativeHandle, rate)
+            require(ret != ERROR_INVALID) { "Unsupported input sample rate: $rate" }
+            check(ret == 0) { "Failed to change input sample rate: $ret" }
+
+            inputSampleRate = rate
+            inputFrameSize = (rate * 10 / 1000) * CHANNELS
+            frameBufferCache = ShortArray(inputFrameSize)
+            outBufferCache = ShortArray(inputFrameSize)
+            floatOutBufferCache = null
+            floatFrameBufferCache = null
+            pcmFrameBufferCache = null
+            pcmOutBufferCache = null
+            Log.i(TAG, "Input sample rate changed to $rate")
+        }
+    }
+
+    /**
+     * Save the denoiser state (RNNoise model memory and resampler history)
+     *
+     * Restoring the blob with restoreState() into another instance with the same
+     * input sample rate and model lets a stream move between instances, threads or
+     * processes without the usual convergence period; output continues
+     * bit-identically. Statistics and samples buffered by processChunk() that do
+     * not yet fill a frame are not included.
+     *
+     * @return Versioned state blob (a few KB)
+     * @throws IllegalStateException if the denoiser has been destroyed, is in
+     *         pipelined mode, or saving fails
+     */
+    suspend fun saveState(): ByteArray = withContext(audioDispatcher) {
+        check(nativeHandle != 0L) { "Denoiser has been destroyed" }
+        check(!pipelined) { "State cannot be saved in pipelined mode" }
+        bufferLock.withLock {
+            saveStateNative(nativeHandle) ?: throw IllegalStateException("Failed to save denoiser state")
+        }
+    }
+
+    /**
+     * Restore a state saved by saveState()
+     *
+     * Discards samples buffered by processChunk(), which belong to the replaced
+     * stream. The next frame continues from the saved point. The resampling
+     * quality the saved instance was running at is restored with it.
+     *
+     * @throws IllegalArgumentException if the blob is malformed or was saved with
+     *         a different input sample rate
+     * @throws IllegalStateException if the denoiser has been destroyed, is in
+     *         pipelined mode, or restoring fails
+     */
+    suspend fun restoreState(state: ByteArray) = withContext(audioDispatcher) {
+        check(nativeHandle != 0L) { "Denoiser has been destroyed" }
+        check(!pipelined) { "State cannot be restored in pipelined mode" }
+        bufferLock.withLock {
+            val ret = restoreStateNative(nativeHandle, state)
+            require(ret != ERROR_INVALID) { "Invalid denoiser state for this configuration" }
+            check(ret == 0) { "Failed to restore denoiser state: $ret" }
+            bufferSize = 0
+        }
+    }
+
 
     /**
      * @brief Calculate the number of samples per frame.
@@ -494,16 +1293,27 @@ class AudxDenoiser private constructor(
 
     /**
      * Destroy the denoiser and free native resources
+     *
+     * A denoiser acquired from an AudxDenoiserPool is reset and returned to the
+     * pool instead.
      */
     fun destroy() {
         if (nativeHandle != 0L) {
             bufferLock.withLock {
                 // Reset buffer to initial size to free memory
                 streamBuffer = ShortArray(inputFrameSize * 4)
+                floatStreamBuffer = FloatArray(0)
+                pcmStreamBuffer = ByteArray(0)
                 bufferSize = 0
             }
-            destroyNative(nativeHandle)
-            Log.i(TAG, "Denoiser destroyed (handle=$nativeHandle)")
+            val pool = ownerPool
+            if (pool != null) {
+                pool.releaseHandle(nativeHandle)
+                Log.i(TAG, "Denoiser returned to pool (handle=$nativeHandle)")
+            } else {
+                destroyNative(nativeHandle)
+                Log.i(TAG, "Denoiser destroyed (handle=$nativeHandle)")
+            }
             nativeHandle = 0
         }
     }
@@ -511,15 +1321,42 @@ class AudxDenoiser private constructor(
     // Native bindings
     private external fun createNative(
         modelPreset: Int, modelPath: String?, vadThreshold: Float, enableVadOutput: Boolean,
-        inputSampleRate: Int, resampleQuality: Int
+        inputSampleRate: Int, resampleQuality: Int, pipelined: Boolean
     ): Long
 
     private external fun destroyNative(handle: Long)
     private external fun processNative(
-        handle: Long, input: ShortArray, output: ShortArray
+        handle: Long, input: ShortArray, output: ShortArray, features: FloatArray?, gains: FloatArray?
     ): DenoiserResult?
 
+    private external fun processFloatNative(
+        handle: Long, input: ShortArray, output: FloatArray, features: FloatArray?, gains: FloatArray?
+    ): DenoiserResult?
+
+    private external fun processFloatInputNative(
+        handle: Long, input: FloatArray, output: FloatArray, features: FloatArray?, gains: FloatArray?
+    ): DenoiserResult?
+
+    private external fun processPcmNative(
+        handle: Long, format: Int, input: ByteArray, output: ByteArray,
+        features: FloatArray?, gains: FloatArray?
+    ): DenoiserResult?
+
+    private external fun processFramesNative(
+        handle: Long, input: ShortArray, inputOffset: Int,
+        output: ShortArray, outputOffset: Int, frames: Int
+    ): Int
+
     private external fun getStatsNative(handle: Long): DenoiserStats?
     private external fun resetStatsNative(handle: Long)
+    private external fun setStageTimingEnabledNative(handle: Long, enabled: Boolean)
+    private external fun getStageTimingsNative(handle: Long): StageTimings?
     private external fun getFrameSamplesNative(inputRate: Int): Int
+    private external fun resetNative(handle: Long)
+    private external fun setInputSampleRateNative(handle: Long, rate: Int): Int
+    private external fun setAdaptiveQualityNative(handle: Long, minQuality: Int, maxQuality: Int): Int
+    private external fun setBandFeaturesNative(handle: Long, enabled: Boolean): Int
+    private external fun setBandGainsNative(handle: Long, enabled: Boolean): Int
+    private external fun saveStateNative(handle: Long): ByteArray?
+    private external fun restoreStateNative(handle: Long, state: ByteArray): Int
 }
@@ -0,0 +1,134 @@
+package com.android.audx
+
+import android.util.Log
+
+/**
+ * Pool of pre-initialized denoisers sharing one configuration
+ *
+ * Creating an AudxDenoiser allocates the RNNoise state and scratch buffers and
+ * sets up two resamplers on the calling thread. A pool does that work once, up
+ * front, so bursts of new streams (e.g. incoming calls) get a denoiser in
+ * microseconds. Destroying an acquired denoiser resets it in place and returns
+ * it to the pool.
+ *
+ * Example usage:
+ * ```
+ * val pool = AudxDenoiser.Builder()
+ *     .inputSampleRate(16000)
+ *     .buildPool(size = 8)
+ *
+ * val denoiser = pool.acquire { audio, result -> send(audio) }
+ * // ... processChunk() / flush() ...
+ * denoiser.destroy()  // Back to the pool
+ *
+ * pool.close()
+ * ```
+ *
+ * Create pools with AudxDenoiser.Builder.buildPool().
+ */
+class AudxDenoiserPool internal constructor(
+    private val config: AudxDenoiser.Builder,
+    val size: Int,
+    modelPreset: Int,
+    modelPath: String?,
+    vadThreshold: Float,
+    enableVadOutput: Boolean,
+    inputSampleRate: Int,
+    resampleQuality: Int
+) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "DenoiserPool"
+
+        init {
+            System.loadLibrary("audx")
+        }
+    }
+
+    private val nativePool: Long = createPoolNative(
+        modelPreset, modelPath, vadThreshold, enableVadOutput,
+        inputSampleRate, resampleQuality, size
+    )
+
+    private var closed = false  // Guarded by this
+
+    init {
+        if (nativePool == 0L) {
+            throw RuntimeException("Failed to create native denoiser pool")
+        }
+        Log.i(TAG, "Pool created (size=$size, inputRate=$inputSampleRate)")
+    }
+
+    /**
+     * Take a denoiser from the pool
+     *
+     * If every pooled denoiser is in use, a new one is created as with
+     * AudxDenoiser.Builder.build() (and destroyed normally later).
+     *
+     * @param callback Callback for processChunk(), as in Builder.onProcessedAudio()
+     * @throws IllegalStateException if the pool has been closed
+     */
+    fun acquire(callback: ProcessedAudioCallback? = null): AudxDenoiser {
+        check(!isClosed()) { "Pool has been closed" }
+        return config.build(this, callback)
+    }
+
+    /**
+     * acquire() with float output, as in Builder.onProcessedFloatAudio()
+     *
+     * @throws IllegalStateException if the pool has been closed
+     */
+    fun acquireFloat(callback: ProcessedFloatAudioCallback): AudxDenoiser {
+        check(!isClosed()) { "Pool has been closed" }
+        return config.build(this, null, floatCallback = callback)
+    }
+
+    /**
+     * acquire() for 24/32-bit PCM, as in Builder.onProcessedPcmAudio()
+     *
+     * @throws IllegalStateException if the pool has been closed
+     */
+    fun acquirePcm(
+        encoding: AudxDenoiser.PcmEncoding,
+        callback: ProcessedPcmAudioCallback
+    ): AudxDenoiser {
+        check(!isClosed()) { "Pool has been closed" }
+        return config.build(this, null, pcmEncoding = encoding, pcmCallback = callback)
+    }
+
+    /**
+     * Close the pool
+     *
+     * Denoisers still in use stay valid; their native memory is freed once the
+     * last of them is destroyed.
+     */
+    override fun close() {
+        synchronized(this) {
+            if (closed) return
+            closed = true
+        }
+        destroyPoolNative(nativePool)
+        Log.i(TAG, "Pool closed")
+    }
+
+    /** Native handle of an idle pooled instance, or 0 if none is left */
+    internal fun acquireHandle(): Long = synchronized(this) {
+        if (closed) 0L else acquireNative(nativePool)
+    }
+
+    internal fun releaseHandle(handle: Long) {
+        releaseNative(nativePool, handle)
+    }
+
+    private fun isClosed(): Boolean = synchronized(this) { closed }
+
+    // Native bindings
+    private external fun createPoolNative(
+        modelPreset: Int, modelPath: String?, vadThreshold: Float, enableVadOutput: Boolean,
+        inputSampleRate: Int, resampleQuality: Int, size: Int
+    ): Long
+
+    private external fun acquireNative(pool: Long): Long
+    private external fun releaseNative(pool: Long, handle: Long)
+    private external fun destroyPoolNative(pool: Long)
+}
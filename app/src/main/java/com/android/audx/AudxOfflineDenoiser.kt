@@ -0,0 +1,286 @@
+package com.android.audx
+
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.async
+import kotlinx.coroutines.awaitAll
+import kotlinx.coroutines.coroutineScope
+import kotlinx.coroutines.ensureActive
+import kotlinx.coroutines.sync.Semaphore
+import kotlinx.coroutines.sync.withPermit
+import kotlinx.coroutines.withContext
+import java.io.File
+import java.io.RandomAccessFile
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Offline (non-real-time) denoiser for complete recordings
+ *
+ * Splits the input into segments and denoises them in parallel, each with its
+ * own native denoiser, so throughput scales with the number of cores instead of
+ * running every 10ms frame through a single instance.
+ *
+ * Each segment is pre-rolled with the audio preceding it so the RNNoise GRU state
+ * (and the resampler history) has converged by the time its output is kept, and
+ * neighbouring segments are joined with a short linear crossfade. The result is
+ * close to, but not bit-identical with, denoising the whole recording with one
+ * AudxDenoiser. It is deterministic and independent of the parallelism.
+ *
+ * Example usage:
+ * ```
+ * val offline = AudxOfflineDenoiser.Builder()
+ *     .denoiser(AudxDenoiser.Builder().inputSampleRate(16000))
+ *     .build()
+ *
+ * val denoised = offline.process(recording)   // ShortArray in, ShortArray out
+ * offline.processFile(File("in.pcm"), File("out.pcm"))
+ * ```
+ */
+class AudxOfflineDenoiser private constructor(
+    private val denoiserBuilder: AudxDenoiser.Builder,
+    private val segmentFrames: Int,
+    private val preRollFrames: Int,
+    private val crossfadeSamples: Int,
+    private val parallelism: Int
+) {
+
+    private val frameSize = denoiserBuilder.frameSamples()
+
+    /**
+     * Builder for AudxOfflineDenoiser
+     */
+    class Builder {
+        private var denoiserBuilder = AudxDenoiser.Builder()
+        private var segmentDurationMs = 30_000
+        private var preRollMs = 500
+        private var crossfadeMs = 10
+        private var parallelism = Runtime.getRuntime().availableProcessors()
+
+        /**
+         * Configuration for the per-segment denoisers (model, input sample rate,
+         * resampler quality). Callbacks set on it are not used, and it must not
+         * enable pipelined mode or adaptive resampler quality, which would make
+         * the output depend on machine load. It is copied by build(), so later
+         * changes do not affect the offline denoiser.
+         */
+        fun denoiser(builder: AudxDenoiser.Builder) = apply { this.denoiserBuilder = builder }
+
+        /**
+         * Length of the audio each segment keeps (default: 30000ms)
+         */
+        fun segmentDurationMs(value: Int) = apply { this.segmentDurationMs = value }
+
+        /**
+         * Audio processed before each segment and discarded, so the denoiser state
+         * converges (default: 500ms)
+         */
+        fun preRollMs(value: Int) = apply { this.preRollMs = value }
+
+        /**
+         * Crossfade between neighbouring segments (default: 10ms)
+         */
+        fun crossfadeMs(value: Int) = apply { this.crossfadeMs = value }
+
+        /**
+         * Maximum number of segments processed at the same time
+         * (default: number of available processors)
+         */
+        fun parallelism(value: Int) = apply { this.parallelism = value }
+
+        fun build(): AudxOfflineDenoiser {
+            require(segmentDurationMs >= 10) { "segmentDurationMs must be at least 10ms" }
+            require(preRollMs >= 0) { "preRollMs must not be negative" }
+            require(crossfadeMs in 0..minOf(segmentDurationMs, preRollMs.coerceAtLeast(0))) {
+                "crossfadeMs must be between 0 and min(segmentDurationMs, preRollMs)"
+            }
+            require(parallelism > 0) { "parallelism must be positive" }
+            require(!denoiserBuilder.isPipelined()) { "Pipelined denoisers are not supported offline" }
+            require(!denoiserBuilder.isAdaptiveQuality()) {
+                "Adaptive resampler quality is not supported offline"
+            }
+
+            val rate = denoiserBuilder.sampleRate()
+            return AudxOfflineDenoiser(
+                denoiserBuilder = denoiserBuilder.copy(),
+                segmentFrames = segmentDurationMs / 10,
+                preRollFrames = (preRollMs + 9) / 10,
+                crossfadeSamples = (rate.toLong() * crossfadeMs / 1000).toInt() * AudxDenoiser.CHANNELS,
+                parallelism = parallelism
+            )
+        }
+    }
+
+    /**
+     * Denoise a complete recording
+     *
+     * @param input 16-bit PCM mono samples at the configured input sample rate
+     * @return Denoised samples, same length as input
+     */
+    suspend fun process(input: ShortArray): ShortArray {
+        if (input.isEmpty()) return ShortArray(0)
+
+        val output = ShortArray(input.size)
+        denoiseSegments(
+            input.size.toLong(),
+            read = { start, window ->
+                // Zero-pad the last partial frame
+                val count = minOf(window.size.toLong(), input.size - start).toInt()
+                System.arraycopy(input, start.toInt(), window, 0, count)
+                window.fill(0, count, window.size)
+            },
+            write = { start, samples, offset, length ->
+                System.arraycopy(samples, offset, output, start.toInt(), length)
+            }
+        )
+        return output
+    }
+
+    /**
+     * Denoise a raw PCM file (16-bit little-endian mono at the configured input
+     * sample rate) into another raw PCM file
+     *
+     * The file is streamed: each segment reads its own audio and pre-roll with
+     * positioned reads and writes its output at its offset, so no more than
+     * `parallelism` segments are in memory at a time, however long the recording.
+     */
+    suspend fun processFile(input: File, output: File) = withContext(Dispatchers.IO) {
+        RandomAccessFile(input, "r").use { inFile ->
+            RandomAccessFile(output, "rw").use { outFile ->
+                val inChannel = inFile.channel
+                val outChannel = outFile.channel
+                val totalSamples = inChannel.size() / 2
+                outFile.setLength(totalSamples * 2)
+
+                denoiseSegments(
+                    totalSamples,
+                    read = { start, window ->
+                        val bytes = ByteBuffer.allocate(window.size * 2).order(ByteOrder.LITTLE_ENDIAN)
+                        var position = start * 2
+                        while (bytes.hasRemaining() && inChannel.read(bytes, position) > 0) {
+                            position = start * 2 + bytes.position()
+                        }
+                        // Past the end of the file reads as silence
+                        val count = bytes.position() / 2
+                        bytes.flip()
+                        bytes.asShortBuffer().get(window, 0, count)
+                        window.fill(0, count, window.size)
+                    },
+                    write = { start, samples, offset, length ->
+                        val bytes = ByteBuffer.allocate(length * 2).order(ByteOrder.LITTLE_ENDIAN)
+                        bytes.asShortBuffer().put(samples, offset, length)
+                        var position = start * 2
+                        while (bytes.hasRemaining()) {
+                            position += outChannel.write(bytes, position)
+                        }
+                    }
+                )
+            }
+        }
+    }
+
+    /** Reads samples [start, start + window.size) of the recording, zero-filled past its end */
+    private fun interface SegmentReader {
+        fun read(start: Long, window: ShortArray)
+    }
+
+    /** Writes [length] denoised samples from [samples] at [start] of the output */
+    private fun interface SegmentWriter {
+        fun write(start: Long, samples: ShortArray, offset: Int, length: Int)
+    }
+
+    /**
+     * Overlapping ends of a segment's output: the crossfade head before its
+     * start and the crossfade tail before its end, both kept out of the output
+     * until the neighbouring segment is done
+     */
+    private class SegmentEdges(val head: ShortArray, val tail: ShortArray)
+
+    /**
+     * Denoise a recording of [totalSamples] segment by segment
+     *
+     * At most `parallelism` segments hold a window at a time, and each writes
+     * its output as soon as it is done; only the crossfade edges are kept
+     * until the end.
+     */
+    private suspend fun denoiseSegments(
+        totalSamples: Long, read: SegmentReader, write: SegmentWriter
+    ) = coroutineScope {
+        val totalFrames = ((totalSamples + frameSize - 1) / frameSize).toInt()
+        val segmentCount = (totalFrames + segmentFrames - 1) / segmentFrames
+        val dispatcher = Dispatchers.Default.limitedParallelism(parallelism)
+        val windows = Semaphore(parallelism)
+
+        val edges = (0 until segmentCount).map { segment ->
+            async(dispatcher) {
+                windows.withPermit {
+                    processSegment(segment, segmentCount, totalFrames, totalSamples, read, write)
+                }
+            }
+        }.awaitAll()
+
+        for (segment in 1 until segmentCount) {
+            val boundary = segment.toLong() * segmentFrames * frameSize
+            val mixed = crossfade(edges[segment - 1].tail, edges[segment].head)
+            write.write(boundary - mixed.size, mixed, 0, mixed.size)
+        }
+    }
+
+    private suspend fun processSegment(
+        segment: Int, segmentCount: Int, totalFrames: Int, totalSamples: Long,
+        read: SegmentReader, write: SegmentWriter
+    ): SegmentEdges = coroutineScope {
+        val startFrame = segment * segmentFrames
+        val endFrame = minOf(totalFrames, startFrame + segmentFrames)
+        val startSample = startFrame.toLong() * frameSize
+        val endSample = minOf(totalSamples, endFrame.toLong() * frameSize)
+
+        // The crossfade head is produced after the pre-roll as well
+        val headStart = if (segment == 0) startSample else maxOf(0L, startSample - crossfadeSamples)
+        val firstFrame = maxOf(0, (headStart / frameSize).toInt() - preRollFrames)
+        val firstSample = firstFrame.toLong() * frameSize
+
+        // processFramesNative() copies each batch out before writing it back,
+        // so the window is denoised in place
+        val window = ShortArray((endFrame - firstFrame) * frameSize)
+        read.read(firstSample, window)
+
+        val denoiser = denoiserBuilder.build()
+        try {
+            var frame = firstFrame
+            while (frame < endFrame) {
+                ensureActive()
+                val batch = minOf(SEGMENT_BATCH_FRAMES, endFrame - frame)
+                val offset = (frame - firstFrame) * frameSize
+                denoiser.processFrames(window, offset, window, offset, batch)
+                frame += batch
+            }
+        } finally {
+            denoiser.destroy()
+        }
+
+        // The tail overlaps the next segment's head and is written with it
+        val tailSamples = if (segment == segmentCount - 1) 0 else crossfadeSamples
+        val bodyStart = (startSample - firstSample).toInt()
+        val bodyEnd = (endSample - firstSample).toInt() - tailSamples
+        write.write(startSample, window, bodyStart, bodyEnd - bodyStart)
+
+        SegmentEdges(
+            head = window.copyOfRange((headStart - firstSample).toInt(), bodyStart),
+            tail = window.copyOfRange(bodyEnd, bodyEnd + tailSamples)
+        )
+    }
+
+    /** Linear crossfade from a segment's tail into the next segment's head */
+    private fun crossfade(tail: ShortArray, head: ShortArray): ShortArray {
+        return ShortArray(head.size) { i ->
+            val w = (i + 0.5f) / head.size
+            val mixed = tail[i] * (1.0f - w) + head[i] * w
+            mixed.toInt().coerceIn(Short.MIN_VALUE.toInt(), Short.MAX_VALUE.toInt()).toShort()
+        }
+    }
+
+    private companion object {
+        // Frames per native call; bounds how long cancellation can take
+        const val SEGMENT_BATCH_FRAMES = 500
+    }
+}